@@ -8,6 +8,10 @@
 #define VEC_SIZE 8
 #define AVX2     1
 
+#if __AVX512F__ == 1
+#define AVX512 1
+#endif
+
 #elif __SSE__ == 1
 
 #define VEC_SIZE 4
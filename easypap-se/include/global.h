@@ -13,6 +13,8 @@ extern unsigned do_first_touch;
 extern int max_iter;
 extern char *easypap_image_file;
 extern char *draw_param;
+extern char *rule_param;
+extern char *boundary_param;
 
 extern unsigned opencl_used;
 extern unsigned easypap_mpirun;
@@ -4,6 +4,7 @@
 typedef void (*void_func_t) (void);
 typedef unsigned (*int_func_t) (unsigned);
 typedef void (*draw_func_t) (char *);
+typedef unsigned (*period_func_t) (void);
 
 extern void_func_t the_first_touch;
 extern void_func_t the_init;
@@ -11,6 +12,9 @@ extern draw_func_t the_draw;
 extern void_func_t the_finalize;
 extern int_func_t the_compute;
 extern void_func_t the_refresh_img;
+// Optional: period of the cycle the board entered when the_compute stopped
+// the computation (1 if the board does not change anymore)
+extern period_func_t the_period;
 
 void *hooks_find_symbol (char *symbol);
 void hooks_establish_bindings (void);
@@ -23,6 +23,11 @@ static inline void swap_images (void)
   alt_image = tmp;
 }
 
+// Set by kernels whose images are rarely written (e.g. boards which do not
+// fit in memory) before img_data_alloc is called: images are then only backed
+// by memory once written
+extern unsigned img_data_lazy;
+
 void img_data_alloc (void);
 void img_data_free (void);
 void img_data_replicate (void);
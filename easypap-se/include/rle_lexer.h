@@ -9,6 +9,8 @@ typedef int (*get_cell_func_t) (int y, int x);
 #define RLE_ORIENTATION_VINVERT 2
 
 void rle_lexer_parse (char *filename, int xo, int yo, set_cell_func_t func, int orientation);
+// Rule found in the header of the last parsed file, or NULL
+char *rle_lexer_rule (void);
 void rle_generate (int x, int y, int width, int height, get_cell_func_t func, char *filename);
 
 #endif
\ No newline at end of file
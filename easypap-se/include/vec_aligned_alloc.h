@@ -7,4 +7,15 @@ void *vec_aligned_malloc (size_t size);
 
 void vec_aligned_free (void *p);
 
+// Zero-filled buffer backed by huge pages when possible (see
+// vec_aligned_alloc.c), returns NULL on failure. huge_free expects the size
+// given to huge_alloc.
+void *huge_alloc (size_t size);
+
+// Same as huge_alloc, but pages are only allocated when first written: no
+// explicit huge page is reserved
+void *huge_alloc_lazy (size_t size);
+
+void huge_free (void *p, size_t size);
+
 #endif
@@ -1,463 +1,4643 @@
 #include "easypap.h"
 #include "rle_lexer.h"
+#include "vec_aligned_alloc.h"
 
+#include <errno.h>
+#include <hwloc.h>
+#include <limits.h>
 #include <omp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
 #include <immintrin.h>
 
-#define NB_TILE (DIM/TILE_SIZE)
+#define NB_TILE ((DIM + TILE_SIZE - 1) / TILE_SIZE)
 
-static int* toSee=NULL;
-static int* isUpdate=NULL;
-static int nb_iteration;
+// Order in which the tiled variants visit tiles (LIFE_TILE_ORDER): row by row
+// by default, or along a Morton (Z-order) or Hilbert curve, so that tiles
+// handed in a row to a thread are neighbours. tile_order[k] is the k-th tile,
+// as ty * NB_TILE + tx, and tile_rank is its inverse. Both are NULL for the
+// row order.
+static unsigned *tile_order = NULL, *tile_rank = NULL;
+
+static inline unsigned tile_at (unsigned k)
+{
+  return tile_order != NULL ? tile_order[k] : k;
+}
+
+// Position of tile t (ty * NB_TILE + tx) in the visit order
+static inline unsigned tile_rank_of (unsigned t)
+{
+  return tile_rank != NULL ? tile_rank[t] : t;
+}
+
+// Tiles which changed at the previous iteration of omp_tiled: one bit per
+// tile, bit b of word w in row ty stands for tile (ty, w * 64 + b). There is a
+// frame of one word and one row so that every tile has eight neighbours.
+#define TB_WORDS ((NB_TILE + 63) / 64)
+#define TB_STRIDE (TB_WORDS + 2)
+#define TB_PLANE ((size_t)(NB_TILE + 2) * TB_STRIDE)
+
+// One bitmap per plane: the tile changed somewhere, or the cells of its north
+// row (resp. south row, ..., south-east corner) changed. The last plane holds
+// the tiles following a cycle, which are visited at each generation.
+enum
+{
+  TILE_SELF,
+  TILE_N,
+  TILE_S,
+  TILE_W,
+  TILE_E,
+  TILE_NW,
+  TILE_NE,
+  TILE_SW,
+  TILE_SE,
+  TILE_PERIODIC,
+  TILE_PLANES
+};
+
+static uint64_t *dirty_tiles  = NULL;
+static unsigned *tile_list    = NULL; // tiles to compute, as ty * NB_TILE + tx
+static uint16_t *tile_changed = NULL; // planes set by each tile of tile_list
+
+#define tile_plane(p) (dirty_tiles + (size_t)(p) * TB_PLANE)
+
+static inline uint64_t *tile_row (uint64_t *t, int ty)
+{
+  return t + (size_t)(ty + 1) * TB_STRIDE + 1;
+}
+
+#define tile_set(t, ty, tx)                                                    \
+  (tile_row ((t), (ty))[(tx) / 64] |= (uint64_t)1 << ((tx) % 64))
 
 static unsigned color = 0xFFFF00FF; // Living cells have the yellow color
 
-typedef unsigned cell_t;
-cl_mem change_buffer,next_change;
+// Cells only hold 0 or 1: one byte each, colours are computed by
+// life_refresh_img
+typedef uint8_t cell_t;
+
+// Tiles whose content, and the cells around them, repeat with a period p <=
+// LIFE_PERIOD_MAX are not computed anymore: their states are replayed until
+// the cells around them differ from the ones seen p generations earlier.
+// Contents are compared through hashes, kept for the last generations.
+typedef struct
+{
+  uint64_t tile;   // hash of the tile computed at this generation
+  uint64_t ring;   // hash of the cells around the tile it was computed from
+  uint16_t planes; // planes set by the tile at this generation
+} tile_step_t;
+
+typedef struct
+{
+  unsigned last;     // last generation recorded in the history
+  unsigned len;      // number of consecutive generations recorded
+  unsigned period;   // period of the tile, 0 if none was found
+  unsigned recorded; // number of states of the cycle recorded (period > 2)
+  cell_t *cycle;     // the states of the cycle (period > 2)
+} tile_period_t;
+
+static unsigned period_max  = 0;
+static unsigned period_hist = 0; // steps kept per tile
+static unsigned tile_gen    = 0;
+static tile_period_t *tile_periods = NULL;
+static tile_step_t *tile_steps     = NULL;
+
+#define tile_step(t, g)                                                        \
+  (tile_steps + (size_t)(t) * period_hist + (g) % period_hist)
+
+// Indexed by the state of a cell and the number of living cells in its 3x3
+// neighbourhood (itself included). Computed from the rule by rule_init, and
+// used to build the lookup table of the lut variants.
+char rules[2][10] = {{0,0,0,1,0,0,0,0,0,0},{0,0,0,1,1,0,0,0,0,0}};
+
+// Life-like rules: bit n of born (resp. survive) is set if a dead (resp.
+// living) cell with n living neighbours is alive at next generation. The
+// following rules get specialised kernels.
+#define RULE_LIFE_BORN 0x008 // B3/S23
+#define RULE_LIFE_SURVIVE 0x00C
+#define RULE_HIGHLIFE_BORN 0x048 // B36/S23
+#define RULE_HIGHLIFE_SURVIVE 0x00C
+#define RULE_DAYNIGHT_BORN 0x1C8 // B3678/S34678
+#define RULE_DAYNIGHT_SURVIVE 0x1D8
+
+enum
+{
+  RULE_LIFE,
+  RULE_HIGHLIFE,
+  RULE_DAYNIGHT,
+  RULE_GENERIC
+};
+
+static unsigned rule_born = RULE_LIFE_BORN, rule_survive = RULE_LIFE_SURVIVE;
+static int rule_id = RULE_LIFE;
+
+// Calls f (..., born, survive) with compile-time masks if the current rule has
+// a specialised version. f should be always_inline, so that its body is
+// instantiated and simplified for each rule.
+#define rule_dispatch(f, ...)                                                  \
+  (rule_id == RULE_LIFE                                                        \
+       ? f (__VA_ARGS__, RULE_LIFE_BORN, RULE_LIFE_SURVIVE)                    \
+       : rule_id == RULE_HIGHLIFE                                              \
+             ? f (__VA_ARGS__, RULE_HIGHLIFE_BORN, RULE_HIGHLIFE_SURVIVE)      \
+             : rule_id == RULE_DAYNIGHT                                        \
+                   ? f (__VA_ARGS__, RULE_DAYNIGHT_BORN, RULE_DAYNIGHT_SURVIVE) \
+                   : f (__VA_ARGS__, rule_born, rule_survive))
+
+#define rule_inline static inline __attribute__ ((always_inline))
+
+// Next state of a cell in state me (0 or 1) with n living cells in its 3x3
+// neighbourhood (itself included). With compile-time masks, only the
+// comparisons needed by the rule remain, so loops using it vectorize.
+rule_inline cell_t rule_next (cell_t me, cell_t n, unsigned born,
+                              unsigned survive)
+{
+  cell_t res = 0;
+
+  for (unsigned k = 0; k <= 9; k++) {
+    const cell_t b = (born >> k) & 1, s = ((survive << 1) >> k) & 1;
+
+    if (b | s)
+      res |= (n == k) & ((b & ~me) | (s & me));
+  }
+
+  return res;
+}
+
+// Cells [x0, x1) of a row, from the rows above, at and below it. Returns
+// non-zero if a cell changed.
+rule_inline cell_t row_next (const cell_t *restrict up,
+                             const cell_t *restrict mid,
+                             const cell_t *restrict down, cell_t *restrict out,
+                             int x0, int x1, unsigned born, unsigned survive)
+{
+  cell_t diff = 0;
+
+  for (int j = x0; j < x1; j++) {
+    const cell_t n = up[j - 1] + up[j] + up[j + 1] + mid[j - 1] + mid[j] +
+                     mid[j + 1] + down[j - 1] + down[j] + down[j + 1];
+
+    out[j] = rule_next (mid[j], n, born, survive);
+    diff |= out[j] ^ mid[j];
+  }
+
+  return diff;
+}
+
+// Parses "B3/S23", "b3/s23" or "23/3" (S/B notation)
+static void rule_parse (const char *str, unsigned *born, unsigned *survive)
+{
+  const char *s  = str;
+  unsigned *mask = survive; // S/B notation unless a letter says otherwise
+  int slash      = 0;
+
+  *born = *survive = 0;
+
+  for (; *s; s++) {
+    if (*s == 'B' || *s == 'b')
+      mask = born;
+    else if (*s == 'S' || *s == 's')
+      mask = survive;
+    else if (*s == '/' && !slash++)
+      mask = born;
+    else if (*s >= '0' && *s <= '8')
+      *mask |= 1 << (*s - '0');
+    else
+      break;
+  }
+
+  if (*s != '\0')
+    exit_with_error ("Cannot parse rule \"%s\" (expected e.g. B3/S23)", str);
+}
+
+static void rule_init (const char *str)
+{
+  unsigned born, survive;
+
+  rule_parse (str, &born, &survive);
+
+  // Every variant relies on empty areas staying empty
+  if (born & 1)
+    exit_with_error ("Rules with B0 (\"%s\") are not supported", str);
+
+  rule_born    = born;
+  rule_survive = survive;
+
+  if (born == RULE_LIFE_BORN && survive == RULE_LIFE_SURVIVE)
+    rule_id = RULE_LIFE;
+  else if (born == RULE_HIGHLIFE_BORN && survive == RULE_HIGHLIFE_SURVIVE)
+    rule_id = RULE_HIGHLIFE;
+  else if (born == RULE_DAYNIGHT_BORN && survive == RULE_DAYNIGHT_SURVIVE)
+    rule_id = RULE_DAYNIGHT;
+  else
+    rule_id = RULE_GENERIC;
+
+  for (int n = 0; n <= 9; n++) {
+    rules[0][n] = (born >> n) & 1;
+    rules[1][n] = n > 0 && ((survive >> (n - 1)) & 1);
+  }
+
+  PRINT_DEBUG ('u', "Rule %s: born = 0x%03x, survive = 0x%03x%s\n", str, born,
+               survive, rule_id == RULE_GENERIC ? " (generic kernels)" : "");
+}
+
+static cell_t *restrict _table = NULL, *restrict _alternate_table = NULL;
+
+// Tables have a frame of one dead cell, so that rows and columns -1 and DIM
+// can be read without any test
+#define PAD_DIM (DIM + 2)
+
+static inline cell_t *table_cell (cell_t *restrict i, int y, int x)
+{
+  return i + (size_t)(y + 1) * PAD_DIM + (x + 1);
+}
+
+// This kernel does not directly work on cur_img/next_img.
+// Instead, we use 2D arrays of boolean values, not colors
+#define cur_table(y, x) (*table_cell (_table, (y), (x)))
+#define next_table(y, x) (*table_cell (_alternate_table, (y), (x)))
+
+// With --boundary torus, the frame holds a copy of the opposite edges of the
+// board instead of dead cells. It is refreshed once per generation, so kernels
+// run unchanged.
+static int torus = 0;
+
+static void torus_refresh (void)
+{
+  for (int i = 0; i < DIM; i++) {
+    cur_table (i, -1)  = cur_table (i, DIM - 1);
+    cur_table (i, DIM) = cur_table (i, 0);
+  }
+
+  // Corners come with the rows
+  memcpy (&cur_table (-1, -1), &cur_table (DIM - 1, -1),
+          PAD_DIM * sizeof (cell_t));
+  memcpy (&cur_table (DIM, -1), &cur_table (0, -1), PAD_DIM * sizeof (cell_t));
+}
+
+// Bounding box of the living cells, maintained by the seq, omp and tiled
+// variants: cells outside are dead. A box is empty if y0 > y1.
+typedef struct
+{
+  int y0, y1, x0, x1;
+} box_t;
+
+static box_t live_box;      // living cells of the current table
+static box_t stale_box;     // living cells left in the next table
+static box_t img_box;       // non-black pixels of the image
+static int live_box_valid = 0, img_box_valid = 0;
+
+// Living cells of the current table in each tile, maintained by the tiled
+// variant so that only the tiles which changed are scanned
+static box_t *tile_boxes   = NULL;
+static int tile_boxes_valid = 0;
+
+static const box_t empty_box = {INT_MAX, -1, INT_MAX, -1};
+
+static inline box_t box_full (void)
+{
+  return (box_t){0, DIM - 1, 0, DIM - 1};
+}
+
+static inline int box_height (box_t b)
+{
+  return max (b.y1 - b.y0 + 1, 0);
+}
+
+static inline int box_width (box_t b)
+{
+  return max (b.x1 - b.x0 + 1, 0);
+}
+
+static inline box_t box_union (box_t a, box_t b)
+{
+  return (box_t){min (a.y0, b.y0), max (a.y1, b.y1), min (a.x0, b.x0),
+                 max (a.x1, b.x1)};
+}
+
+// On a torus, cells of the opposite edge are neighbours: the box is not used
+static inline int box_enabled (void)
+{
+  return !torus;
+}
+
+// Adds the living cells of row y of the next table, between columns x0 and x1
+static inline void box_add_row (box_t *b, int y, int x0, int x1)
+{
+  const cell_t *row = &next_table (y, 0);
+  const cell_t *first = memchr (row + x0, 1, x1 - x0 + 1);
+
+  if (first == NULL)
+    return;
+
+  int last = x1;
+  while (!row[last])
+    last--;
+
+  b->y0 = min (b->y0, y);
+  b->y1 = max (b->y1, y);
+  b->x0 = min (b->x0, (int)(first - row));
+  b->x1 = max (b->x1, last);
+}
+
+// Returns the region to compute at next generation: the living cells and
+// their neighbours, plus the living cells left in the next table which must
+// be cleared
+static box_t box_region (void)
+{
+  if (!live_box_valid) {
+    live_box = empty_box;
+    for (int i = 0; i < DIM; i++) {
+      const cell_t *row   = &cur_table (i, 0);
+      const cell_t *first = memchr (row, 1, DIM);
+
+      if (first != NULL) {
+        int last = DIM - 1;
+        while (!row[last])
+          last--;
+        live_box = box_union (live_box, (box_t){i, i, first - row, last});
+      }
+    }
+
+    // The next table is not known
+    stale_box        = box_full ();
+    live_box_valid   = 1;
+    tile_boxes_valid = 0;
+  }
+
+  box_t r = live_box;
+
+  if (r.y0 <= r.y1) {
+    r.y0 = max (r.y0 - 1, 0);
+    r.y1 = min (r.y1 + 1, (int)DIM - 1);
+    r.x0 = max (r.x0 - 1, 0);
+    r.x1 = min (r.x1 + 1, (int)DIM - 1);
+  }
+
+  return box_union (r, stale_box);
+}
+
+// To be called with the living cells of the generation just computed, before
+// swapping tables
+static inline void box_next (box_t b)
+{
+  stale_box = live_box;
+  live_box  = b;
+}
+
+// Bit-packed storage used by the bitboard variants: one bit per cell, so bit b
+// of word w in row y holds cell (y, w * BB_BITS + b). As for tables, there is
+// a frame of dead words around the board.
+typedef uint64_t bb_word_t;
+
+#define BB_BITS 64
+#define BB_WORDS ((DIM + BB_BITS - 1) / BB_BITS)
+#define BB_STRIDE (BB_WORDS + 2)
+
+static bb_word_t *restrict _bb_table = NULL, *restrict _bb_alternate_table = NULL;
+
+static inline bb_word_t *bb_row (bb_word_t *restrict t, int y)
+{
+  return t + (size_t)(y + 1) * BB_STRIDE + 1;
+}
+
+#define cur_bb(y, w) (bb_row (_bb_table, (y))[(w)])
+#define next_bb(y, w) (bb_row (_bb_alternate_table, (y))[(w)])
+
+// Tile-major storage used by the blocked variants: each tile is stored
+// contiguously, with a halo of one cell around it. Tiles of the last row and
+// column are stored full size, cells out of the board being dead.
+#define BLK_SIDE (TILE_SIZE + 2)
+#define BLK_CELLS ((size_t)BLK_SIDE * BLK_SIDE)
+
+static cell_t *restrict _blk_table = NULL, *restrict _blk_alternate_table = NULL;
+
+// Tiles are stored in the order they are visited
+static inline cell_t *blk_tile (cell_t *restrict t, int ty, int tx)
+{
+  return t + (size_t)tile_rank_of (ty * NB_TILE + tx) * BLK_CELLS;
+}
+
+// Cell (y, x) of the board
+static inline cell_t *blk_cell (cell_t *restrict t, int y, int x)
+{
+  return blk_tile (t, y / TILE_SIZE, x / TILE_SIZE) +
+         (y % TILE_SIZE + 1) * BLK_SIDE + x % TILE_SIZE + 1;
+}
+
+#define cur_blk(y, x) (*blk_cell (_blk_table, (y), (x)))
+
+// Quadtree node used by the hashlife variant
+typedef struct hl_node
+{
+  struct hl_node *nw, *ne, *sw, *se;
+  struct hl_node *result; // central square, 2^(level-2) generations later
+  struct hl_node *next;   // hash chain
+  unsigned level;
+  unsigned mark;
+} hl_node_t;
+
+static hl_node_t *hl_root = NULL;
+
+// Tile of the unbounded variants, indexed by its coordinates in ut_buckets
+typedef struct ut_tile ut_tile_t;
+
+static ut_tile_t **ut_buckets = NULL;
+
+// Live cells of the sparse variant, as sorted coordinate keys
+static uint64_t *sp_cells = NULL;
+
+// Files of the current and next tables of the stream variant, which are also
+// mapped on _table and _alternate_table
+static int stream_fd[2] = {-1, -1};
+
+static inline int variant_is_bitboard (void)
+{
+  return !strncmp (variant_name, "bitboard", strlen ("bitboard"));
+}
+
+static void bb_init (void);
+static void bb_finalize (void);
+static void bb_refresh_img (void);
+static void blk_init (void);
+static void tile_order_init (void);
+static void affinity_init (void);
+static void blk_finalize (void);
+static void blk_refresh_img (void);
+static void hl_init (void);
+static void hl_finalize (void);
+static void hl_refresh_img (void);
+static void ut_init (void);
+static void ut_finalize (void);
+static void ut_refresh_img (void);
+static void sp_init (void);
+static void sp_finalize (void);
+static void sp_refresh_img (void);
+static void stream_init (void);
+static void stream_finalize (void);
+static void stream_refresh_img (void);
+static void lut_init (void);
+static void period_init (void);
+static void period_finalize (void);
+static void cycle_check (void);
+static void cycle_init (void);
+static void cycle_finalize (void);
+
+static void boundary_init (void)
+{
+  if (boundary_param == NULL || !strcmp (boundary_param, "dead"))
+    torus = 0;
+  else if (!strcmp (boundary_param, "torus"))
+    torus = 1;
+  else
+    exit_with_error ("Unknown boundary mode \"%s\" (expected dead or torus)",
+                     boundary_param);
+
+  if (torus && (!strcmp (variant_name, "hashlife") ||
+                !strcmp (variant_name, "sparse") ||
+                !strncmp (variant_name, "unbounded", strlen ("unbounded"))))
+    exit_with_error ("Variant %s has no boundary: torus mode is not supported",
+                     variant_name);
+
+  if (torus && !strcmp (variant_name, "diamond"))
+    PRINT_DEBUG ('u', "Torus mode: diamond blocks are cut down to one "
+                      "generation\n");
+}
+
+void life_init (void)
+{
+  if (rule_param != NULL)
+    rule_init (rule_param);
+
+  boundary_init ();
+  cycle_check ();
+
+  if (tile_order == NULL)
+    tile_order_init ();
+
+  affinity_init ();
+
+  if (variant_is_bitboard ()) {
+    bb_init ();
+    return;
+  }
+
+  if (!strncmp (variant_name, "blocked", strlen ("blocked"))) {
+    blk_init ();
+    return;
+  }
+
+  if (!strncmp (variant_name, "unbounded", strlen ("unbounded"))) {
+    ut_init ();
+    return;
+  }
+
+  if (!strcmp (variant_name, "sparse")) {
+    sp_init ();
+    return;
+  }
+
+  if (!strcmp (variant_name, "hashlife")) {
+    // Draw functions use the bitboard as a staging area
+    bb_init ();
+    hl_init ();
+    return;
+  }
+
+  if (!strcmp (variant_name, "stream")) {
+    stream_init ();
+    return;
+  }
+
+  if (!strncmp (variant_name, "lut", strlen ("lut")))
+    lut_init ();
+
+  // life_init may be (indirectly) called several times so we check if data were
+  // already allocated
+  if (_table == NULL) {
+    const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+    // The inplace variant works on a single table
+    const int nb_tables = strcmp (variant_name, "inplace") ? 2 : 1;
+
+    PRINT_DEBUG ('u', "Memory footprint = %d x %zu bytes\n", nb_tables, size);
+
+    _table = huge_alloc (size);
+    if (_table == NULL)
+      exit_with_error ("Cannot allocate tables: mmap failed");
+
+    if (nb_tables == 2) {
+      _alternate_table = huge_alloc (size);
+      if (_alternate_table == NULL)
+        exit_with_error ("Cannot allocate tables: mmap failed");
+    }
+
+    dirty_tiles  = calloc (TILE_PLANES * TB_PLANE, sizeof (uint64_t));
+    tile_list    = malloc ((size_t)NB_TILE * NB_TILE * sizeof (unsigned));
+    tile_changed = malloc ((size_t)NB_TILE * NB_TILE * sizeof (uint16_t));
+
+    // Every tile is computed at the first iteration
+    for (int ty = 0; ty < NB_TILE; ty++)
+      for (int tx = 0; tx < NB_TILE; tx++)
+        tile_set (tile_plane (TILE_SELF), ty, tx);
+
+    if (!strcmp (variant_name, "omp_tiled"))
+      period_init ();
+
+    if (!strcmp (variant_name, "tiled"))
+      tile_boxes = malloc ((size_t)NB_TILE * NB_TILE * sizeof (box_t));
+
+    cycle_init ();
+  }
+}
+
+void life_finalize (void)
+{
+  if (variant_is_bitboard ()) {
+    bb_finalize ();
+    return;
+  }
+
+  if (_blk_table != NULL) {
+    blk_finalize ();
+    return;
+  }
+
+  if (ut_buckets != NULL) {
+    ut_finalize ();
+    return;
+  }
+
+  if (sp_cells != NULL) {
+    sp_finalize ();
+    return;
+  }
+
+  if (!strcmp (variant_name, "hashlife")) {
+    if (_bb_table != NULL)
+      bb_finalize ();
+    hl_finalize ();
+    return;
+  }
+
+  if (stream_fd[0] != -1) {
+    stream_finalize ();
+    return;
+  }
+
+  const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+
+  huge_free (_table, size);
+  huge_free (_alternate_table, size);
+
+  free (dirty_tiles);
+  free (tile_list);
+  free (tile_changed);
+  free (tile_boxes);
+  tile_boxes = NULL;
+
+  if (tile_periods != NULL)
+    period_finalize ();
+
+  cycle_finalize ();
+}
+
+// This function is called whenever the graphical window needs to be refreshed
+void life_refresh_img (void)
+{
+  if (hl_root != NULL) {
+    hl_refresh_img ();
+    return;
+  }
+
+  if (ut_buckets != NULL) {
+    ut_refresh_img ();
+    return;
+  }
+
+  if (sp_cells != NULL) {
+    sp_refresh_img ();
+    return;
+  }
+
+  if (_bb_table != NULL) {
+    bb_refresh_img ();
+    return;
+  }
+
+  if (_blk_table != NULL) {
+    blk_refresh_img ();
+    return;
+  }
+
+  if (stream_fd[0] != -1) {
+    stream_refresh_img ();
+    return;
+  }
+
+  // Pixels outside both the living cells and the pixels painted last time are
+  // already black
+  const int tracked = live_box_valid && box_enabled ();
+  const box_t r =
+      tracked && img_box_valid ? box_union (live_box, img_box) : box_full ();
+
+  for (int i = r.y0; i <= r.y1; i++)
+    for (int j = r.x0; j <= r.x1; j++)
+      cur_img (i, j) = cur_table (i, j) * color;
+
+  img_box       = live_box;
+  img_box_valid = tracked;
+}
+
+static inline void swap_tables (void)
+{
+  cell_t *tmp = _table;
+
+  _table           = _alternate_table;
+  _alternate_table = tmp;
+}
+
+///////////////////////////// Sequential version (seq)
+
+// Cells [x0, x1) of row y, from the current table to the next one
+rule_inline cell_t table_row_next (int y, int x0, int x1, unsigned born,
+                                   unsigned survive)
+{
+  return row_next (&cur_table (y - 1, 0), &cur_table (y, 0),
+                   &cur_table (y + 1, 0), &next_table (y, 0), x0, x1, born,
+                   survive);
+}
+
+// Returns 1 if a cell changed. Changes are detected by each thread and
+// combined by the caller, so no shared flag is written.
+static int do_row (int y, int x0, int x1)
+{
+  return rule_dispatch (table_row_next, y, x0, x1) != 0;
+}
+
+unsigned life_compute_seq (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    if (torus)
+      torus_refresh ();
+
+    // Only the bounding box of living cells, grown by one cell, is computed
+    const int tracked = box_enabled ();
+    const box_t r     = tracked ? box_region () : box_full ();
+    box_t b           = empty_box;
+
+    monitoring_start_tile (0);
+
+    for (int i = r.y0; i <= r.y1; i++) {
+      change |= do_row (i, r.x0, r.x1 + 1);
+      if (tracked)
+        box_add_row (&b, i, r.x0, r.x1);
+    }
+
+    monitoring_end_tile (r.x0, r.y0, box_width (r), box_height (r), 0);
+
+    if (tracked)
+      box_next (b);
+    swap_tables ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// OpenCL version (ocl)
+// Suggested cmdline:
+// ./run -k life -o -v ocl -s 4096 -a random -i 1000
+//
+// The GPU works on its own byte buffers, which have the layout of _table,
+// frame included. The frame stays dead, or in torus mode is refreshed by the
+// life_frame kernel before each generation, so that the life_ocl kernel reads
+// neighbours without any test. Colours are only written to cur_buffer once
+// per call of life_invoke_ocl, for the display.
+
+static cl_mem cell_buffer = NULL, next_cell_buffer = NULL;
+static cl_kernel colour_kernel = NULL, frame_kernel = NULL;
+
+void life_draw (char *param);
+
+// Copies between _table and a cell buffer
+static void life_transfer_ocl (cl_mem buffer, int to_gpu)
+{
+  const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+  cl_int err;
+
+  if (to_gpu)
+    err = clEnqueueWriteBuffer (queue, buffer, CL_TRUE, 0, size, _table, 0,
+                                NULL, NULL);
+  else
+    err = clEnqueueReadBuffer (queue, buffer, CL_TRUE, 0, size, _table, 0,
+                               NULL, NULL);
+  check (err, "Failed to transfer cells between host and GPU");
+}
+
+void life_init_ocl (void)
+{
+  const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+
+  life_init ();
+
+  // Both buffers start as copies of the empty table, so that their frames
+  // are dead
+  cell_buffer = clCreateBuffer (
+      context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, size, _table, NULL);
+  if (!cell_buffer)
+    exit_with_error ("Failed to allocate cell buffer");
+
+  next_cell_buffer = clCreateBuffer (
+      context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, size, _table, NULL);
+  if (!next_cell_buffer)
+    exit_with_error ("Failed to allocate next cell buffer");
+}
+
+void life_draw_ocl (char *param)
+{
+  life_draw (param);
+
+  life_transfer_ocl (cell_buffer, 1);
+
+  // Initial image, sent to cur_buffer by ocl_send_image
+  life_refresh_img ();
+}
+
+void life_refresh_img_ocl (void)
+{
+  life_transfer_ocl (cell_buffer, 0);
+
+  life_refresh_img ();
+}
+
+// Kernels of the same program as compute_kernel
+static void life_create_kernels_ocl (void)
+{
+  cl_program program;
+  cl_int err;
+
+  err = clGetKernelInfo (compute_kernel, CL_KERNEL_PROGRAM, sizeof (program),
+                         &program, NULL);
+  check (err, "Failed to get OpenCL program");
+
+  colour_kernel = clCreateKernel (program, "life_colour", &err);
+  check (err, "Failed to create kernel <life_colour>");
+
+  frame_kernel = clCreateKernel (program, "life_frame", &err);
+  check (err, "Failed to create kernel <life_frame>");
+}
+
+unsigned life_invoke_ocl (unsigned nb_iter)
+{
+  size_t global[2] = {SIZE, SIZE};   // global domain size for our calculation
+  size_t local[2]  = {TILEX, TILEY}; // local domain size for our calculation
+  cl_int err;
+
+  if (colour_kernel == NULL)
+    life_create_kernels_ocl ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    if (torus) {
+      const size_t edge = DIM; // one work item per row and column
+
+      err = clSetKernelArg (frame_kernel, 0, sizeof (cl_mem), &cell_buffer);
+      check (err, "Failed to set kernel arguments");
+
+      err = clEnqueueNDRangeKernel (queue, frame_kernel, 1, NULL, &edge, NULL,
+                                    0, NULL, NULL);
+      check (err, "Failed to execute kernel");
+    }
+
+    // Set kernel arguments
+    //
+    err = 0;
+    err |= clSetKernelArg (compute_kernel, 0, sizeof (cl_mem), &cell_buffer);
+    err |= clSetKernelArg (compute_kernel, 1, sizeof (cl_mem),
+                           &next_cell_buffer);
+    err |= clSetKernelArg (compute_kernel, 2, sizeof (unsigned), &rule_born);
+    err |= clSetKernelArg (compute_kernel, 3, sizeof (unsigned), &rule_survive);
+    check (err, "Failed to set kernel arguments");
+
+    err = clEnqueueNDRangeKernel (queue, compute_kernel, 2, NULL, global, local,
+                                  0, NULL, NULL);
+    check (err, "Failed to execute kernel");
+
+    // Swap buffers
+    {
+      cl_mem tmp       = cell_buffer;
+      cell_buffer      = next_cell_buffer;
+      next_cell_buffer = tmp;
+    }
+  }
+
+  err = 0;
+  err |= clSetKernelArg (colour_kernel, 0, sizeof (cl_mem), &cell_buffer);
+  err |= clSetKernelArg (colour_kernel, 1, sizeof (cl_mem), &cur_buffer);
+  check (err, "Failed to set kernel arguments");
+
+  err = clEnqueueNDRangeKernel (queue, colour_kernel, 2, NULL, global, local, 0,
+                                NULL, NULL);
+  check (err, "Failed to execute kernel");
+
+  return 0;
+}
+
+///////////////////////////// Tiled sequential version (tiled)
+
+unsigned life_compute_omp (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    if (torus)
+      torus_refresh ();
+
+    const int tracked = box_enabled ();
+    const box_t r     = tracked ? box_region () : box_full ();
+    int y0 = INT_MAX, y1 = -1, x0 = INT_MAX, x1 = -1;
+
+    monitoring_start_tile (0);
+
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : change)            \
+    reduction(min : y0, x0) reduction(max : y1, x1)
+    for (int i = r.y0; i <= r.y1; i++) {
+      box_t b = empty_box;
+
+      change |= do_row (i, r.x0, r.x1 + 1);
+
+      if (tracked) {
+        box_add_row (&b, i, r.x0, r.x1);
+        y0 = min (y0, b.y0);
+        y1 = max (y1, b.y1);
+        x0 = min (x0, b.x0);
+        x1 = max (x1, b.x1);
+      }
+    }
+
+    monitoring_end_tile (r.x0, r.y0, box_width (r), box_height (r), 0);
+
+    if (tracked)
+      box_next ((box_t){y0, y1, x0, x1});
+    swap_tables ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+// The global VEC_SIZE counts 32-bit lanes of the AVX2 registers; the Life
+// kernel works on byte cells and picks its own width
+#if defined(ENABLE_VECTO) && AVX512 == 1 && defined(__AVX512BW__)
+#define LIFE_VEC_SIZE 64
+#elif defined(ENABLE_VECTO) && AVX2 == 1
+#define LIFE_VEC_SIZE 32
+#endif
+
+#ifdef LIFE_VEC_SIZE
+
+// Vectorized tile kernel: LIFE_VEC_SIZE adjacent cells (one per byte lane) are
+// computed at once. The vertical sums of the three rows are kept in registers
+// and shifted by one lane to get the west/east columns, so each cell is loaded
+// three times instead of nine.
+
+#if LIFE_VEC_SIZE == 64
+
+typedef __m512i vcell_t;
+
+#define vec_load(p) _mm512_loadu_si512 ((void *)(p))
+#define vec_store(p, v) _mm512_storeu_si512 ((void *)(p), (v))
+#define vec_add(a, b) _mm512_add_epi8 ((a), (b))
+#define vec_set1(n) _mm512_set1_epi8 (n)
+
+// [prev[63], cur[0..62]] and [cur[1..63], next[0]]. alignr_epi8 works inside
+// 128-bit lanes, so the crossing lanes are first gathered with alignr_epi64.
+#define vec_west(prev, cur)                                                    \
+  _mm512_alignr_epi8 ((cur), _mm512_alignr_epi64 ((cur), (prev), 6), 15)
+#define vec_east(cur, next)                                                    \
+  _mm512_alignr_epi8 (_mm512_alignr_epi64 ((next), (cur), 2), (cur), 1)
+
+// n counts the cell itself, see rule_next
+rule_inline vcell_t vec_life (vcell_t n, vcell_t me, int *diff, unsigned born,
+                              unsigned survive)
+{
+  const __mmask64 me_alive = _mm512_test_epi8_mask (me, me);
+  __mmask64 alive          = 0;
+
+  for (unsigned k = 0; k <= 9; k++) {
+    const unsigned b = (born >> k) & 1, s = ((survive << 1) >> k) & 1;
+
+    if (b | s)
+      alive |= _mm512_cmpeq_epi8_mask (n, _mm512_set1_epi8 (k)) &
+               (b ? (s ? ~(__mmask64)0 : ~me_alive) : me_alive);
+  }
+
+  *diff = alive != me_alive;
+  return _mm512_maskz_mov_epi8 (alive, _mm512_set1_epi8 (1));
+}
+
+#else
+
+typedef __m256i vcell_t;
+
+#define vec_load(p) _mm256_loadu_si256 ((__m256i *)(p))
+#define vec_store(p, v) _mm256_storeu_si256 ((__m256i *)(p), (v))
+#define vec_add(a, b) _mm256_add_epi8 ((a), (b))
+#define vec_set1(n) _mm256_set1_epi8 (n)
+
+// alignr works inside 128-bit lanes, so the crossing halves are first
+// gathered with permute2x128
+#define vec_west(prev, cur)                                                    \
+  _mm256_alignr_epi8 ((cur), _mm256_permute2x128_si256 ((prev), (cur), 0x21), \
+                      15)
+#define vec_east(cur, next)                                                    \
+  _mm256_alignr_epi8 (_mm256_permute2x128_si256 ((cur), (next), 0x21), (cur), \
+                      1)
+
+rule_inline vcell_t vec_life (vcell_t n, vcell_t me, int *diff, unsigned born,
+                              unsigned survive)
+{
+  const vcell_t me_alive = _mm256_cmpeq_epi8 (me, _mm256_set1_epi8 (1));
+  vcell_t alive          = _mm256_setzero_si256 ();
+
+  for (unsigned k = 0; k <= 9; k++) {
+    const unsigned b = (born >> k) & 1, s = ((survive << 1) >> k) & 1;
+
+    if (b | s) {
+      const vcell_t eq = _mm256_cmpeq_epi8 (n, _mm256_set1_epi8 (k));
+
+      alive = _mm256_or_si256 (
+          alive, b ? (s ? eq : _mm256_andnot_si256 (me_alive, eq))
+                   : _mm256_and_si256 (me_alive, eq));
+    }
+  }
+
+  const vcell_t next = _mm256_and_si256 (alive, _mm256_set1_epi8 (1));
+  const vcell_t d    = _mm256_xor_si256 (next, me);
+
+  *diff = !_mm256_testz_si256 (d, d);
+  return next;
+}
+
+#endif
+
+static inline cell_t col_sum (int y, int x)
+{
+  return cur_table (y - 1, x) + cur_table (y, x) + cur_table (y + 1, x);
+}
+
+static inline vcell_t vec_col_sum (int y, int x)
+{
+  return vec_add (vec_add (vec_load (&cur_table (y - 1, x)),
+                           vec_load (&cur_table (y, x))),
+                  vec_load (&cur_table (y + 1, x)));
+}
+
+// Tile inner computation, instantiated for each rule by do_tile_reg. Returns
+// 1 if a cell of the tile changed.
+rule_inline int do_tile_rule (int x, int y, int width, int height,
+                              unsigned born, unsigned survive)
+{
+  int diff = 0;
+
+  for (int i = y; i < y + height; i++) {
+    int j       = x;
+    vcell_t prv = vec_set1 (col_sum (i, x - 1));
+    vcell_t cur = vec_col_sum (i, x);
+
+    for (; j + LIFE_VEC_SIZE <= x + width; j += LIFE_VEC_SIZE) {
+      // Past the last full vector, only lane 0 of nxt (column
+      // j + LIFE_VEC_SIZE) is used, so we avoid reading beyond the tile
+      const vcell_t nxt = (j + 2 * LIFE_VEC_SIZE <= x + width)
+                              ? vec_col_sum (i, j + LIFE_VEC_SIZE)
+                              : vec_set1 (col_sum (i, j + LIFE_VEC_SIZE));
+      const vcell_t n =
+          vec_add (vec_add (vec_west (prv, cur), cur), vec_east (cur, nxt));
+      int d;
+
+      vec_store (&next_table (i, j),
+                 vec_life (n, vec_load (&cur_table (i, j)), &d, born, survive));
+      diff |= d;
+
+      prv = cur;
+      cur = nxt;
+    }
+
+    diff |= table_row_next (i, j, x + width, born, survive) != 0;
+  }
+
+  return diff;
+}
+
+static int do_tile_reg (int x, int y, int width, int height)
+{
+  return rule_dispatch (do_tile_rule, x, y, width, height);
+}
+
+#else
+
+// Tile inner computation, instantiated for each rule by do_tile_reg. Returns
+// 1 if a cell of the tile changed.
+rule_inline int do_tile_rule (int x, int y, int width, int height,
+                              unsigned born, unsigned survive)
+{
+  cell_t diff = 0;
+
+  for (int i = y; i < y + height; i++)
+    diff |= table_row_next (i, x, x + width, born, survive);
+
+  return diff != 0;
+}
+
+static int do_tile_reg (int x, int y, int width, int height)
+{
+  return rule_dispatch (do_tile_rule, x, y, width, height);
+}
+
+#endif
+
+static int do_tile (int x, int y, int width, int height, int who)
+{
+  int diff;
+
+  monitoring_start_tile (who);
+
+  diff = do_tile_reg (x, y, width, height);
+
+  monitoring_end_tile (x, y, width, height, who);
+
+  return diff;
+}
+
+// Coordinates of the d-th point of a Morton curve
+static void morton_d2xy (unsigned d, unsigned *x, unsigned *y)
+{
+  *x = *y = 0;
+  for (unsigned b = 0; d != 0; b++, d >>= 2) {
+    *x |= (d & 1) << b;
+    *y |= (d >> 1 & 1) << b;
+  }
+}
+
+// Coordinates of the d-th point of a Hilbert curve filling a side x side
+// square, side being a power of two
+static void hilbert_d2xy (unsigned side, unsigned d, unsigned *x, unsigned *y)
+{
+  *x = *y = 0;
+  for (unsigned s = 1; s < side; s *= 2, d /= 4) {
+    const unsigned rx = 1 & (d / 2), ry = 1 & (d ^ rx);
+
+    if (ry == 0) {
+      if (rx == 1) {
+        *x = s - 1 - *x;
+        *y = s - 1 - *y;
+      }
+
+      const unsigned tmp = *x;
+      *x                 = *y;
+      *y                 = tmp;
+    }
+
+    *x += s * rx;
+    *y += s * ry;
+  }
+}
+
+static void tile_order_init (void)
+{
+  char *str = getenv ("LIFE_TILE_ORDER");
+  unsigned side = 1, k = 0;
+
+  if (str == NULL || !strcmp (str, "row"))
+    return;
+
+  if (strcmp (str, "morton") && strcmp (str, "hilbert"))
+    exit_with_error ("Unknown tile order \"%s\" (expected row, morton or "
+                     "hilbert)",
+                     str);
+
+  PRINT_DEBUG ('u', "Tiles are visited in %s order\n", str);
+
+  tile_order = malloc ((size_t)NB_TILE * NB_TILE * sizeof (unsigned));
+  tile_rank  = malloc ((size_t)NB_TILE * NB_TILE * sizeof (unsigned));
+
+  // The curve fills the smallest power of two square holding all tiles, and
+  // points out of the board are skipped
+  while (side < NB_TILE)
+    side *= 2;
+
+  for (unsigned d = 0; d < side * side; d++) {
+    unsigned tx, ty;
+
+    if (str[0] == 'm')
+      morton_d2xy (d, &tx, &ty);
+    else
+      hilbert_d2xy (side, d, &tx, &ty);
+
+    if (tx < NB_TILE && ty < NB_TILE) {
+      tile_rank[ty * NB_TILE + tx] = k;
+      tile_order[k++]              = ty * NB_TILE + tx;
+    }
+  }
+}
+
+static inline uint64_t hash_mix (uint64_t h, uint64_t v)
+{
+  h = (h + v) * 0x9E3779B97F4A7C15ULL;
+
+  return h ^ (h >> 29);
+}
+
+static inline uint64_t hash_cells (uint64_t h, const cell_t *c, int n)
+{
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    uint64_t v;
+
+    memcpy (&v, c + i, sizeof (v));
+    h = hash_mix (h, v);
+  }
+
+  for (; i < n; i++)
+    h = hash_mix (h, c[i]);
+
+  return h;
+}
+
+// Hash of a tile of the given table
+static uint64_t tile_hash (cell_t *table, int x, int y, int width, int height)
+{
+  uint64_t h = 0;
+
+  for (int i = y; i < y + height; i++)
+    h = hash_cells (h, table_cell (table, i, x), width);
+
+  return h;
+}
+
+// Whole-board cycle detection, for the tiled and omp_tiled variants.
+// Suggested cmdline:
+// LIFE_CYCLE_MAX=16 ./run -k life -v omp_tiled -s 1024 -ts 32 -a random -n -i 100000
+//
+// The board hash is the xor of the hashes of its tiles, which are only updated
+// for the tiles which changed. The computation stops as soon as the board hash
+// is the same as p <= LIFE_CYCLE_MAX generations earlier, and p is reported by
+// life_period.
+#define CYCLE_MAX_PERIOD 1024
+
+static unsigned cycle_max    = 0;
+static uint64_t *cycle_tiles = NULL; // hash of each tile, mixed with its index
+static uint64_t *cycle_hist  = NULL; // board hashes of the last generations
+static unsigned cycle_len    = 0;    // number of generations recorded
+static unsigned cycle_found  = 0;    // period of the cycle entered, if any
+
+// Called before any variant-specific initialization, so that every variant
+// but tiled and omp_tiled rejects LIFE_CYCLE_MAX
+static void cycle_check (void)
+{
+  char *str = getenv ("LIFE_CYCLE_MAX");
+
+  if (str == NULL)
+    return;
+
+  cycle_max = atoi (str);
+  if (cycle_max < 2 || cycle_max > CYCLE_MAX_PERIOD)
+    exit_with_error ("LIFE_CYCLE_MAX (%d) should be between 2 and %d",
+                     cycle_max, CYCLE_MAX_PERIOD);
+
+  if (strcmp (variant_name, "tiled") && strcmp (variant_name, "omp_tiled"))
+    exit_with_error ("Variant %s does not support cycle detection",
+                     variant_name);
+}
+
+static void cycle_init (void)
+{
+  if (cycle_max == 0)
+    return;
+
+  PRINT_DEBUG ('u', "Looking for cycles with a period up to %d\n", cycle_max);
+
+  cycle_tiles = calloc ((size_t)NB_TILE * NB_TILE, sizeof (uint64_t));
+  cycle_hist  = calloc (cycle_max + 1, sizeof (uint64_t));
+}
+
+static void cycle_finalize (void)
+{
+  free (cycle_tiles);
+  free (cycle_hist);
+  cycle_tiles = NULL;
+}
+
+// Records the hash of tile t of the next table, and returns the difference to
+// xor into the board hash
+static inline uint64_t cycle_tile_update (unsigned t, uint64_t hash)
+{
+  const uint64_t old = cycle_tiles[t];
+
+  cycle_tiles[t] = hash_mix (t, hash);
+
+  return old ^ cycle_tiles[t];
+}
+
+// The board is hashed as a whole before the first generation
+static void cycle_start (void)
+{
+  uint64_t h = 0;
+
+  for (int ty = 0; ty < NB_TILE; ty++)
+    for (int tx = 0; tx < NB_TILE; tx++) {
+      const int x = tx * TILE_SIZE, y = ty * TILE_SIZE;
+
+      cycle_tiles[ty * NB_TILE + tx] =
+          hash_mix (ty * NB_TILE + tx,
+                    tile_hash (_table, x, y, min (TILE_SIZE, DIM - x),
+                               min (TILE_SIZE, DIM - y)));
+      h ^= cycle_tiles[ty * NB_TILE + tx];
+    }
+
+  cycle_hist[0] = h;
+  cycle_len     = 1;
+}
+
+// Records the board hash of the generation which has just been computed, given
+// the xor of the updates of its tiles. Returns the period of the cycle the
+// board entered, or 0.
+static unsigned cycle_step (uint64_t diff)
+{
+  const unsigned hist = cycle_max + 1;
+  const uint64_t h    = cycle_hist[(cycle_len - 1) % hist] ^ diff;
+
+  cycle_hist[cycle_len % hist] = h;
+  cycle_len++;
+
+  // Period 1 is detected by variants, since no cell changes
+  for (unsigned p = 2; p <= min (cycle_max, cycle_len - 1); p++)
+    if (cycle_hist[(cycle_len - 1 - p) % hist] == h) {
+      PRINT_DEBUG ('u', "Cycle of period %u entered at generation %u\n", p,
+                   cycle_len - 1 - p);
+      cycle_found = p;
+      return p;
+    }
+
+  return 0;
+}
+
+// Hook called once a variant stopped the computation: either on a cycle found
+// by cycle_step, or because the board does not change anymore
+unsigned life_period (void)
+{
+  return cycle_found ? cycle_found : 1;
+}
+
+unsigned life_compute_tiled (unsigned nb_iter)
+{
+  if (cycle_tiles != NULL && cycle_len == 0)
+    cycle_start ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change    = 0;
+    uint64_t diff = 0;
+
+    if (torus)
+      torus_refresh ();
+
+    // Only the tiles overlapping the bounding box of living cells, grown by
+    // one cell, are computed. The box of the next generation is the union of
+    // the boxes of these tiles: a tile which did not change keeps its box, the
+    // others are scanned while still in cache.
+    const int tracked = box_enabled ();
+    const box_t r     = tracked ? box_region () : box_full ();
+    const int fresh   = tile_boxes_valid;
+    box_t b           = empty_box;
+
+    for (unsigned t = 0; t < NB_TILE * NB_TILE; t++) {
+      const unsigned tile = tile_at (t);
+      const int y         = tile / NB_TILE * TILE_SIZE;
+      const int x         = tile % NB_TILE * TILE_SIZE;
+      const int w = min (TILE_SIZE, DIM - x), h = min (TILE_SIZE, DIM - y);
+
+      // Cells outside r are dead in both tables
+      if (y + h <= r.y0 || y > r.y1 || x + w <= r.x0 || x > r.x1) {
+        if (tracked)
+          tile_boxes[tile] = empty_box;
+        continue;
+      }
+
+      const int changed = do_tile (x, y, w, h, 0);
+
+      if (changed) {
+        change = 1;
+        if (cycle_tiles != NULL)
+          diff ^= cycle_tile_update (tile,
+                                     tile_hash (_alternate_table, x, y, w, h));
+      }
+
+      if (tracked) {
+        if (changed || !fresh) {
+          tile_boxes[tile] = empty_box;
+          for (int i = y; i < y + h; i++)
+            box_add_row (&tile_boxes[tile], i, x, x + w - 1);
+        }
+        b = box_union (b, tile_boxes[tile]);
+      }
+    }
+
+    if (tracked)
+      box_next (b);
+    tile_boxes_valid = tracked;
+    swap_tables ();
+
+    if (!change) // we stop when all cells are stable
+      return it;
+
+    if (cycle_tiles != NULL && cycle_step (diff))
+      return it;
+  }
+
+  return 0;
+}
+
+// NUMA placement of tiles, for the first touch and the omp_tiled variants.
+// Suggested cmdline:
+// OMP_PROC_BIND=close LIFE_AFFINITY=numa ./run -k life -v omp_tiled -s 16384 -ts 64 -a random -n -i 1000 -ft
+//
+// Each thread owns a contiguous span of tiles in the visit order, threads of
+// the same NUMA node owning neighbouring spans. life_ft touches the tables
+// along these spans, so that the pages of a tile are allocated on the node of
+// its owner. With LIFE_AFFINITY=numa, omp_tiled and blocked_omp_tiled compute
+// every tile on its owner instead of balancing the load dynamically: threads
+// should then be bound to cores.
+
+typedef struct
+{
+  unsigned begin, end; // ranks of the first and past-the-last tiles
+} tile_span_t;
+
+static tile_span_t *tile_spans = NULL; // span of each OpenMP thread
+static int tile_affinity       = 0;
+
+// NUMA node of the core the calling thread runs on (0 if unknown)
+static int thread_numa_node (hwloc_topology_t topo)
+{
+  hwloc_cpuset_t cpus   = hwloc_bitmap_alloc ();
+  hwloc_nodeset_t nodes = hwloc_bitmap_alloc ();
+  int node              = 0;
+
+  if (!hwloc_get_last_cpu_location (topo, cpus, HWLOC_CPUBIND_THREAD)) {
+    hwloc_cpuset_to_nodeset (topo, cpus, nodes);
+    node = max (hwloc_bitmap_first (nodes), 0);
+  }
+
+  hwloc_bitmap_free (cpus);
+  hwloc_bitmap_free (nodes);
+
+  return node;
+}
+
+static void affinity_init (void)
+{
+  char *str            = getenv ("LIFE_AFFINITY");
+  const int nb_threads = omp_get_max_threads ();
+  const uint64_t nb    = (uint64_t)NB_TILE * NB_TILE;
+  int *node;
+
+  if (tile_spans != NULL)
+    return;
+
+  if (str != NULL && strcmp (str, "none") && strcmp (str, "numa"))
+    exit_with_error ("Unknown affinity \"%s\" (expected none or numa)", str);
+
+  tile_affinity = str != NULL && !strcmp (str, "numa");
+  tile_spans    = malloc (nb_threads * sizeof (tile_span_t));
+  node          = calloc (nb_threads, sizeof (int));
+
+  if (tile_affinity) {
+    hwloc_topology_t topo;
+
+    hwloc_topology_init (&topo);
+    hwloc_topology_load (topo);
+
+#pragma omp parallel
+    node[omp_get_thread_num ()] = thread_numa_node (topo);
+
+    PRINT_DEBUG ('u', "Tiles are bound to %d threads on %d NUMA node(s)\n",
+                 nb_threads,
+                 max (hwloc_get_nbobjs_by_type (topo, HWLOC_OBJ_NUMANODE), 1));
+
+    hwloc_topology_destroy (topo);
+  }
+
+  // Spans are dealt node by node, then by thread number
+  for (int slot = 0; slot < nb_threads; slot++) {
+    int t = -1;
+
+    for (int i = 0; i < nb_threads; i++)
+      if (node[i] >= 0 && (t == -1 || node[i] < node[t]))
+        t = i;
+
+    tile_spans[t] = (tile_span_t){nb * slot / nb_threads,
+                                  nb * (slot + 1) / nb_threads};
+    node[t]       = -1;
+  }
+
+  free (node);
+}
+
+// Index of the first tile of tile_list (of length n) whose rank is at least
+// rank: tile_list is sorted by rank
+static unsigned tile_list_find (unsigned n, unsigned rank)
+{
+  unsigned lo = 0, hi = n;
+
+  while (lo < hi) {
+    const unsigned mid = (lo + hi) / 2;
+
+    if (tile_rank_of (tile_list[mid]) < rank)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+static void ft_touch (cell_t *table, int x, int y, int width, int height)
+{
+  for (int i = y; i < y + height; i++)
+    memset (table_cell (table, i, x), 0, width * sizeof (cell_t));
+}
+
+// Touches the tables with the mapping of tiles used by omp_tiled when
+// LIFE_AFFINITY=numa (bit-packed, sparse and file-backed variants are left
+// alone)
+void life_ft (void)
+{
+  if (stream_fd[0] != -1)
+    return;
+
+#pragma omp parallel
+  {
+    const tile_span_t s = tile_spans[omp_get_thread_num ()];
+
+    for (unsigned k = s.begin; k < s.end; k++) {
+      const int ty = tile_at (k) / NB_TILE, tx = tile_at (k) % NB_TILE;
+      const int x = tx * TILE_SIZE, y = ty * TILE_SIZE;
+      const int w = min (TILE_SIZE, DIM - x), h = min (TILE_SIZE, DIM - y);
+
+      if (_blk_table != NULL) {
+        memset (blk_tile (_blk_table, ty, tx), 0, BLK_CELLS * sizeof (cell_t));
+        memset (blk_tile (_blk_alternate_table, ty, tx), 0,
+                BLK_CELLS * sizeof (cell_t));
+      } else if (_table != NULL) {
+        ft_touch (_table, x, y, w, h);
+        if (_alternate_table != NULL)
+          ft_touch (_alternate_table, x, y, w, h);
+      }
+    }
+  }
+}
+
+// On a torus, tiles of the first and last rows (resp. columns) are neighbours:
+// the frame of the bitmap holds a copy of them
+static void tile_bits_wrap (uint64_t *t)
+{
+  const int last = NB_TILE - 1;
+
+  for (int ty = 0; ty < NB_TILE; ty++) {
+    uint64_t *r = tile_row (t, ty);
+
+    if (r[last / 64] >> (last % 64) & 1)
+      r[-1] |= (uint64_t)1 << 63;
+    if (r[0] & 1)
+      tile_set (t, ty, NB_TILE);
+  }
+
+  memcpy (tile_row (t, -1) - 1, tile_row (t, last) - 1,
+          TB_STRIDE * sizeof (uint64_t));
+  memcpy (tile_row (t, NB_TILE) - 1, tile_row (t, 0) - 1,
+          TB_STRIDE * sizeof (uint64_t));
+}
+
+// Word w of row ty, shifted so that each bit stands for the tile at its east
+// (resp. west)
+static inline uint64_t tile_bits_east (uint64_t *t, int ty, int w)
+{
+  const uint64_t *r = tile_row (t, ty);
+
+  return r[w] << 1 | r[w - 1] >> 63;
+}
+
+static inline uint64_t tile_bits_west (uint64_t *t, int ty, int w)
+{
+  const uint64_t *r = tile_row (t, ty);
+
+  return r[w] >> 1 | r[w + 1] << 63;
+}
+
+static int tile_rank_cmp (const void *a, const void *b)
+{
+  const unsigned ra = tile_rank[*(const unsigned *)a];
+  const unsigned rb = tile_rank[*(const unsigned *)b];
+
+  return (ra > rb) - (ra < rb);
+}
+
+// Builds the list of tiles to compute: a tile is computed if itself changed at
+// the previous iteration, or if one of its neighbours changed along the border
+// they share. The list is sorted by rank in the visit order. Returns its
+// length.
+static unsigned tile_list_build (void)
+{
+  const unsigned rem = NB_TILE % 64;
+  const uint64_t last_mask = rem ? ((uint64_t)1 << rem) - 1 : ~(uint64_t)0;
+  unsigned n = 0;
+
+  for (int ty = 0; ty < NB_TILE; ty++)
+    for (int w = 0; w < TB_WORDS; w++) {
+      uint64_t wake = tile_row (tile_plane (TILE_SELF), ty)[w] |
+                      tile_row (tile_plane (TILE_PERIODIC), ty)[w] |
+                      tile_row (tile_plane (TILE_S), ty - 1)[w] |
+                      tile_row (tile_plane (TILE_N), ty + 1)[w] |
+                      tile_bits_east (tile_plane (TILE_E), ty, w) |
+                      tile_bits_west (tile_plane (TILE_W), ty, w) |
+                      tile_bits_east (tile_plane (TILE_SE), ty - 1, w) |
+                      tile_bits_west (tile_plane (TILE_SW), ty - 1, w) |
+                      tile_bits_east (tile_plane (TILE_NE), ty + 1, w) |
+                      tile_bits_west (tile_plane (TILE_NW), ty + 1, w);
+
+      if (w == TB_WORDS - 1)
+        wake &= last_mask;
+
+      while (wake) {
+        tile_list[n++] = ty * NB_TILE + w * 64 + __builtin_ctzll (wake);
+        wake &= wake - 1;
+      }
+    }
+
+  // Tiles are found in row order: only the tiles to compute are sorted
+  if (tile_order != NULL)
+    qsort (tile_list, n, sizeof (unsigned), tile_rank_cmp);
+
+  return n;
+}
+
+// Planes set by a tile which has just been computed: its borders are compared
+// between the two tables
+static uint16_t tile_edges (int x, int y, int width, int height)
+{
+  const int xe = x + width - 1, ye = y + height - 1;
+  uint16_t planes = 1 << TILE_SELF;
+
+  if (memcmp (&cur_table (y, x), &next_table (y, x), width))
+    planes |= 1 << TILE_N;
+  if (memcmp (&cur_table (ye, x), &next_table (ye, x), width))
+    planes |= 1 << TILE_S;
+
+  for (int i = y; i <= ye; i++) {
+    if (cur_table (i, x) != next_table (i, x))
+      planes |= 1 << TILE_W;
+    if (cur_table (i, xe) != next_table (i, xe))
+      planes |= 1 << TILE_E;
+  }
+
+  if (cur_table (y, x) != next_table (y, x))
+    planes |= 1 << TILE_NW;
+  if (cur_table (y, xe) != next_table (y, xe))
+    planes |= 1 << TILE_NE;
+  if (cur_table (ye, x) != next_table (ye, x))
+    planes |= 1 << TILE_SW;
+  if (cur_table (ye, xe) != next_table (ye, xe))
+    planes |= 1 << TILE_SE;
+
+  return planes;
+}
+
+// Computes a tile and returns the planes it sets
+static uint16_t tile_compute (int x, int y, int width, int height, int who)
+{
+  if (do_tile (x, y, width, height, who))
+    return tile_edges (x, y, width, height);
+
+  return 0;
+}
+
+// Suggested cmdline:
+// LIFE_PERIOD_MAX=4 ./run -k life -v omp_tiled -s 4096 -ts 32 -a random -n -i 3000
+// (LIFE_PERIOD_MAX=1 only puts still tiles to sleep)
+#define PERIOD_DEFAULT_MAX 4
+#define PERIOD_MAX 16
+
+static void period_init (void)
+{
+  char *str = getenv ("LIFE_PERIOD_MAX");
+
+  period_max = str ? atoi (str) : PERIOD_DEFAULT_MAX;
+  if (period_max < 1 || period_max > PERIOD_MAX)
+    exit_with_error ("LIFE_PERIOD_MAX (%d) should be between 1 and %d",
+                     period_max, PERIOD_MAX);
+
+  PRINT_DEBUG ('u', "Tiles with a period up to %d are frozen\n", period_max);
+
+  if (period_max == 1) // period 1 is already handled by dirty tiles
+    return;
+
+  period_hist  = period_max + 1;
+  tile_periods = calloc ((size_t)NB_TILE * NB_TILE, sizeof (tile_period_t));
+  tile_steps   = calloc ((size_t)NB_TILE * NB_TILE * period_hist,
+                         sizeof (tile_step_t));
+}
+
+static void period_finalize (void)
+{
+  for (size_t t = 0; t < (size_t)NB_TILE * NB_TILE; t++)
+    free (tile_periods[t].cycle);
+
+  free (tile_periods);
+  free (tile_steps);
+  tile_periods = NULL;
+}
+
+// Hash of the cells around a tile in the current table
+static uint64_t tile_ring_hash (int x, int y, int width, int height)
+{
+  uint64_t h = hash_cells (0, &cur_table (y - 1, x - 1), width + 2);
+  uint64_t v = 0;
+
+  h = hash_cells (h, &cur_table (y + height, x - 1), width + 2);
+
+  for (int i = 0; i < height; i++) {
+    v = v << 2 | cur_table (y + i, x - 1) << 1 | cur_table (y + i, x + width);
+    if (i % 32 == 31) {
+      h = hash_mix (h, v);
+      v = 0;
+    }
+  }
+
+  return hash_mix (h, v);
+}
+
+static void tile_cycle_copy (cell_t *cycle, int x, int y, int width,
+                             int height, int to_table)
+{
+  for (int i = 0; i < height; i++)
+    if (to_table)
+      memcpy (&next_table (y + i, x), cycle + i * width, width);
+    else
+      memcpy (cycle + i * width, &next_table (y + i, x), width);
+}
+
+// Same as tile_compute, for the tile t at generation tile_gen: frozen tiles
+// are replayed, and the history of the other ones is updated to find a period
+static uint16_t period_do_tile (unsigned t, int x, int y, int width,
+                                int height, int who)
+{
+  tile_period_t *tp = tile_periods + t;
+  const unsigned g  = tile_gen;
+  const unsigned p  = tp->period;
+  const uint64_t ring = tile_ring_hash (x, y, width, height);
+  tile_step_t *now    = tile_step (t, g);
+
+  // Neither the tile nor the cells around it changed while it was not
+  // computed
+  if (tp->len > 0 && tp->last != g - 1) {
+    const tile_step_t *prev = tile_step (t, tp->last);
+
+    for (unsigned k = 1; k < min (g - tp->last, period_hist); k++) {
+      tile_step (t, g - k)->tile   = prev->tile;
+      tile_step (t, g - k)->ring   = prev->ring;
+      tile_step (t, g - k)->planes = 0;
+    }
+    tp->len = min (tp->len + g - tp->last - 1, period_hist);
+  }
+
+  if (p && (p <= 2 || tp->recorded == p)) {
+    const tile_step_t *before = tile_step (t, g - p);
+
+    if (ring == before->ring) {
+      // States of periods 1 and 2 are already in the tables
+      if (p > 2)
+        tile_cycle_copy (tp->cycle + (size_t)(g % p) * width * height, x, y,
+                         width, height, 1);
+
+      now->tile   = before->tile;
+      now->ring   = ring;
+      now->planes = before->planes;
+      tp->last    = g;
+
+      return now->planes | 1 << TILE_PERIODIC;
+    }
+
+    // Disturbed by a neighbour: the tile is computed again
+    PRINT_DEBUG ('u', "Tile %u wakes up at generation %u\n", t, g);
+    free (tp->cycle);
+    tp->cycle  = NULL;
+    tp->period = 0;
+  }
+
+  now->planes = tile_compute (x, y, width, height, who);
+  now->tile   = tile_hash (_alternate_table, x, y, width, height);
+  now->ring   = ring;
+  tp->len     = min (tp->len + 1, period_hist);
+  tp->last    = g;
+
+  if (tp->period) { // recording the states of a cycle
+    const tile_step_t *before = tile_step (t, g - p);
+
+    if (now->tile == before->tile && now->ring == before->ring) {
+      tile_cycle_copy (tp->cycle + (size_t)(g % p) * width * height, x, y,
+                       width, height, 0);
+      tp->recorded++;
+    } else {
+      free (tp->cycle);
+      tp->cycle  = NULL;
+      tp->period = 0;
+    }
+  } else if (tp->len > 1 && (now->tile != tile_step (t, g - 1)->tile ||
+                             now->ring != tile_step (t, g - 1)->ring))
+    // Still tiles (period 1) just sleep as long as nothing changes around
+    for (unsigned q = 2; q < tp->len; q++) {
+      const tile_step_t *before = tile_step (t, g - q);
+
+      if (now->tile == before->tile && now->ring == before->ring) {
+        tp->period = q;
+        if (q > 2) {
+          tp->cycle = malloc ((size_t)q * width * height * sizeof (cell_t));
+          tile_cycle_copy (tp->cycle + (size_t)(g % q) * width * height, x, y,
+                           width, height, 0);
+          tp->recorded = 1;
+        }
+        break;
+      }
+    }
+
+  return now->planes | (tp->period ? 1 << TILE_PERIODIC : 0);
+}
+
+// Computes the i-th tile of tile_list, returns 1 if some cell changed
+static int omp_tiled_do_entry (unsigned i, uint64_t *diff, int who)
+{
+  const int ty = tile_list[i] / NB_TILE;
+  const int tx = tile_list[i] % NB_TILE;
+  const int x = tx * TILE_SIZE, y = ty * TILE_SIZE;
+  const int w = min (TILE_SIZE, DIM - x), h = min (TILE_SIZE, DIM - y);
+
+  if (tile_periods != NULL)
+    tile_changed[i] = period_do_tile (tile_list[i], x, y, w, h, who);
+  else
+    tile_changed[i] = tile_compute (x, y, w, h, who);
+
+  // The hash of the tile has already been computed if periods are tracked
+  if (cycle_tiles != NULL && tile_changed[i] >> TILE_SELF & 1)
+    *diff ^= cycle_tile_update (tile_list[i],
+                                tile_periods != NULL
+                                    ? tile_step (tile_list[i], tile_gen)->tile
+                                    : tile_hash (_alternate_table, x, y, w, h));
+
+  return (tile_changed[i] & ~(1 << TILE_PERIODIC)) != 0;
+}
+
+unsigned life_compute_omp_tiled (unsigned nb_iter)
+{
+  if (cycle_tiles != NULL && cycle_len == 0)
+    cycle_start ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change    = 0;
+    uint64_t diff = 0;
+
+    if (torus) {
+      torus_refresh ();
+      for (int p = 0; p < TILE_PLANES; p++)
+        tile_bits_wrap (tile_plane (p));
+    }
+
+    const unsigned n = tile_list_build ();
+
+    // Each entry of tile_changed is only written by the thread computing the
+    // tile, and the end of the loop is the only synchronization
+    if (tile_affinity)
+#pragma omp parallel reduction(| : change) reduction(^ : diff)
+    {
+      const int me        = omp_get_thread_num ();
+      const tile_span_t s = tile_spans[me];
+
+      // The tiles of a span are contiguous in tile_list
+      for (unsigned i = tile_list_find (n, s.begin);
+           i < n && tile_rank_of (tile_list[i]) < s.end; i++)
+        change |= omp_tiled_do_entry (i, &diff, me);
+    }
+    else
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : change)          \
+    reduction(^ : diff)
+      for (unsigned i = 0; i < n; i++)
+        change |= omp_tiled_do_entry (i, &diff, omp_get_thread_num ());
+
+    memset (dirty_tiles, 0, TILE_PLANES * TB_PLANE * sizeof (uint64_t));
+    for (unsigned i = 0; i < n; i++)
+      for (int p = 0; p < TILE_PLANES; p++)
+        if (tile_changed[i] >> p & 1)
+          tile_set (tile_plane (p), tile_list[i] / NB_TILE,
+                    tile_list[i] % NB_TILE);
+
+    tile_gen++;
+    swap_tables ();
+    if (!change) // we stop when all cells are stable
+      return it;
+
+    if (cycle_tiles != NULL && cycle_step (diff))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Temporal blocking version (omp_tiled_ghost)
+// Suggested cmdline:
+// LIFE_GHOST_K=4 ./run -k life -v omp_tiled_ghost -s 8192 -ts 256 -a random -n -i 100
+//
+// Each tile is loaded with a halo of K cells into a thread-private buffer,
+// where K generations are computed without synchronization: the valid area
+// shrinks by one cell per generation, so the halo is recomputed redundantly
+// by neighbouring tiles. Only the tile itself is written back. The board is
+// thus streamed once and threads join once every K generations.
+
+#define GHOST_DEFAULT_K 4
+#define GHOST_MAX_K 32
+
+static unsigned ghost_k = 0;
+static cell_t **ghost_buffers = NULL; // per thread: two (TS + 2K)^2 buffers
+
+static void ghost_init (void)
+{
+  char *str = getenv ("LIFE_GHOST_K");
+
+  ghost_k = str ? atoi (str) : GHOST_DEFAULT_K;
+  if (ghost_k < 1 || ghost_k > GHOST_MAX_K)
+    exit_with_error ("LIFE_GHOST_K (%d) should be between 1 and %d", ghost_k,
+                     GHOST_MAX_K);
+
+  PRINT_DEBUG ('u', "Temporal blocking: %d generations per tile pass\n",
+               ghost_k);
+
+  ghost_buffers = calloc (omp_get_max_threads (), sizeof (cell_t *));
+}
+
+static inline int torus_wrap (int v)
+{
+  const int dim = DIM;
+
+  return (v % dim + dim) % dim;
+}
+
+// On a torus, rows and columns of the halo wrap around. A row is copied by
+// contiguous segments, as the halo may be larger than the board.
+static void ghost_load_torus (cell_t *buf, int gy0, int gx0, int side)
+{
+  for (int i = 0; i < side; i++) {
+    const cell_t *in = &cur_table (torus_wrap (gy0 + i), 0);
+    cell_t *row      = buf + i * side;
+
+    for (int j = 0, c = torus_wrap (gx0); j < side; c = 0) {
+      const int len = min (side - j, (int)DIM - c);
+
+      memcpy (row + j, in + c, len);
+      j += len;
+    }
+  }
+}
+
+// Computes k generations of the tile at (x, y) inside buf, returns a mask
+// whose bit s - 1 is set if the tile changed at generation s
+rule_inline unsigned ghost_do_tile_rule (int x, int y, int k, cell_t *buf,
+                                         unsigned born, unsigned survive)
+{
+  const int side = TILE_SIZE + 2 * ghost_k;
+  const int gy0 = y - ghost_k, gx0 = x - ghost_k; // global coords of buf[0]
+  cell_t *src = buf, *dst = buf + side * side;
+  unsigned mask = 0;
+
+  // Load the tile and its halo, cells out of the board being dead
+  if (torus)
+    ghost_load_torus (src, gy0, gx0, side);
+  else {
+    const int j_begin = max (0, -gx0), j_end = min (side, DIM - gx0);
+
+    memset (src, 0, side * side);
+    for (int i = max (0, -gy0); i < min (side, DIM - gy0); i++)
+      memcpy (src + i * side + j_begin, &cur_table (gy0 + i, gx0 + j_begin),
+              j_end - j_begin);
+  }
+  memcpy (dst, src, side * side);
+
+  for (int s = 1; s <= k; s++) {
+    // The valid area shrinks by one cell per generation, and cells out of
+    // the board stay dead, unless they wrap around
+    const int i_begin = torus ? s : max (s, -gy0);
+    const int i_end   = torus ? side - s : min (side - s, DIM - gy0);
+    const int j_begin = torus ? s : max (s, -gx0);
+    const int j_end   = torus ? side - s : min (side - s, DIM - gx0);
+    cell_t diff      = 0;
+
+    for (int i = i_begin; i < i_end; i++) {
+      const cell_t *mid = src + i * side;
+      cell_t *out       = dst + i * side;
+
+      row_next (mid - side, mid, mid + side, out, j_begin, j_end, born,
+                survive);
+
+      // Changes are only tracked inside the tile
+      if (i >= ghost_k && i < ghost_k + TILE_SIZE)
+        for (int j = max (j_begin, (int)ghost_k);
+             j < min (j_end, (int)ghost_k + TILE_SIZE); j++)
+          diff |= out[j] ^ mid[j];
+    }
+
+    if (diff)
+      mask |= 1U << (s - 1);
+
+    cell_t *tmp = src;
+    src          = dst;
+    dst          = tmp;
+  }
+
+  // Write the tile back
+  for (int i = y; i < min (y + TILE_SIZE, DIM); i++)
+    memcpy (&next_table (i, x), src + (i - gy0) * side + ghost_k,
+            min (TILE_SIZE, DIM - x));
+
+  return mask;
+}
+
+static unsigned ghost_do_tile_reg (int x, int y, int k, cell_t *buf)
+{
+  return rule_dispatch (ghost_do_tile_rule, x, y, k, buf);
+}
+
+static unsigned ghost_do_tile (int x, int y, int k, int who)
+{
+  const int side = TILE_SIZE + 2 * ghost_k;
+  unsigned mask;
+
+  if (ghost_buffers[who] == NULL)
+    ghost_buffers[who] = malloc (2 * side * side);
+
+  monitoring_start_tile (who);
+
+  mask = ghost_do_tile_reg (x, y, k, ghost_buffers[who]);
+
+  monitoring_end_tile (x, y, TILE_SIZE, TILE_SIZE, who);
+
+  return mask;
+}
+
+unsigned life_compute_omp_tiled_ghost (unsigned nb_iter)
+{
+  if (ghost_buffers == NULL)
+    ghost_init ();
+
+  for (unsigned it = 1; it <= nb_iter; it += ghost_k) {
+    const int k   = min (ghost_k, nb_iter - it + 1);
+    unsigned mask = 0;
+
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : mask)
+    for (unsigned t = 0; t < NB_TILE * NB_TILE; t++)
+      mask |= ghost_do_tile (tile_at (t) % NB_TILE * TILE_SIZE,
+                             tile_at (t) / NB_TILE * TILE_SIZE, k,
+                             omp_get_thread_num ());
+
+    swap_tables ();
+
+    // The board is stable from the first generation without any change
+    if (~mask & (~0U >> (GHOST_MAX_K - k)))
+      return it + __builtin_ctz (~mask);
+  }
+
+  return 0;
+}
+
+///////////////////////////// Time-skewed wavefront version (diamond)
+// Suggested cmdline:
+// ./run -k life -v diamond -s 4096 -ts 128 -a random -n -i 1000
+//
+// Space-time is cut into skewed tiles: during a block of T generations, tile
+// (ty, tx) computes at generation s (1 <= s <= T) the TILE_SIZE x TILE_SIZE
+// square shifted by s cells up and left. A task computes one tile for the T
+// generations of a block, so its data stays in cache, and nothing is
+// computed twice. A task depends on the tiles above and left of it in the
+// same block, and on the ones below and right of it in the previous block.
+// Tasks therefore run along wavefronts, and the tasks of all blocks are
+// created at once: a block starts on a corner of the board while the
+// previous one still runs on the opposite corner. The two tables are enough,
+// because a cell is only overwritten once every task reading its previous
+// value has completed.
+//
+// The last task of a block checks whether a generation of the block left the
+// board unchanged. Once one did, the remaining tasks return without
+// computing anything: the board is still, so both tables already hold it.
+//
+// In torus mode, tiles of one edge need the previous generation of the
+// opposite edge, which skewed tiles cannot provide: blocks are cut down to
+// one generation, with a taskwait and a frame refresh between them, which
+// amounts to plain tiling.
+
+#define DIAMOND_MAX_T 64
+
+// Generations [1, k] of a block for the skewed tile (ty, tx). Bit s - 1 of
+// the result is set if a cell changed at generation s.
+rule_inline uint64_t diamond_do_tile_rule (int ty, int tx, int k,
+                                           cell_t *buf[2], unsigned born,
+                                           unsigned survive)
+{
+  const int ts = TILE_SIZE, dim = DIM;
+  uint64_t mask = 0;
+
+  for (int s = 1; s <= k; s++) {
+    cell_t *src       = buf[(s - 1) % 2], *dst = buf[s % 2];
+    const int i_begin = max (ty * ts - s, 0);
+    const int i_end   = min (ty * ts + ts - s, dim);
+    const int j_begin = max (tx * ts - s, 0);
+    const int j_end   = min (tx * ts + ts - s, dim);
+    cell_t diff       = 0;
+
+    for (int i = i_begin; i < i_end; i++)
+      diff |= row_next (table_cell (src, i - 1, 0), table_cell (src, i, 0),
+                        table_cell (src, i + 1, 0), table_cell (dst, i, 0),
+                        j_begin, j_end, born, survive);
+
+    if (diff)
+      mask |= (uint64_t)1 << (s - 1);
+  }
+
+  return mask;
+}
+
+static uint64_t diamond_do_tile_reg (int ty, int tx, int k, cell_t *buf[2])
+{
+  return rule_dispatch (diamond_do_tile_rule, ty, tx, k, buf);
+}
+
+static uint64_t diamond_do_tile (int ty, int tx, int k, cell_t *buf[2],
+                                 int who)
+{
+  // Monitoring shows the square computed at the last generation
+  const int ts = TILE_SIZE, dim = DIM;
+  const int x __attribute__ ((unused)) = min (max (tx * ts - k, 0), dim);
+  const int y __attribute__ ((unused)) = min (max (ty * ts - k, 0), dim);
+  uint64_t mask;
+
+  monitoring_start_tile (who);
+
+  mask = diamond_do_tile_reg (ty, tx, k, buf);
+
+  monitoring_end_tile (x, y, min (tx * ts + ts - k, dim) - x,
+                       min (ty * ts + ts - k, dim) - y, who);
+
+  return mask;
+}
+
+unsigned life_compute_diamond (unsigned nb_iter)
+{
+  // Tiles shifted by up to T cells: one more row and column of tiles
+  const int nb_tiles      = NB_TILE + 1;
+  const int T             = torus ? 1 : min (DIAMOND_MAX_T, (int)TILE_SIZE / 2);
+  const unsigned nb_block = T < 1 ? 0 : (nb_iter + T - 1) / T;
+  // Dependency sentinels, with a one-tile frame to avoid special cases
+  char(*dep)[nb_tiles + 2] = calloc (nb_tiles + 2, nb_tiles + 2);
+  // Per block: generations with a change, and tiles left to compute
+  uint64_t *mask    = calloc (nb_block, sizeof (uint64_t));
+  int *left         = malloc (nb_block * sizeof (int));
+  cell_t *tables[2] = {_table, _alternate_table};
+  unsigned res      = 0;
+
+  if (T < 1)
+    exit_with_error ("TILE_SIZE (%d) is too small for the diamond variant",
+                     TILE_SIZE);
+
+  for (unsigned b = 0; b < nb_block; b++)
+    left[b] = nb_tiles * nb_tiles;
+
+#pragma omp parallel
+#pragma omp single
+  for (unsigned b = 0; b < nb_block; b++) {
+    const unsigned it = 1 + b * T;
+    const int k       = min (T, nb_iter - it + 1);
+    // Table holding generation it - 1 (the tables are swapped between the
+    // blocks of the torus mode)
+    const int p = torus ? 0 : (it - 1) % 2;
+    unsigned stop;
+
+    if (torus && b > 0) {
+#pragma omp taskwait
+    }
+
+#pragma omp atomic read
+    stop = res;
+    if (stop)
+      break;
+
+    if (torus) {
+      if (b > 0) {
+        swap_tables ();
+        tables[0] = _table;
+        tables[1] = _alternate_table;
+      }
+      torus_refresh ();
+    }
+
+    for (int ty = 0; ty < nb_tiles; ty++)
+      for (int tx = 0; tx < nb_tiles; tx++) {
+#pragma omp task firstprivate(ty, tx, b, it, k, p) shared(mask, left, res)    \
+    depend(in : dep[ty][tx], dep[ty][tx + 1], dep[ty + 1][tx],                 \
+           dep[ty + 2][tx + 1], dep[ty + 1][tx + 2], dep[ty + 2][tx + 2])      \
+    depend(inout : dep[ty + 1][tx + 1])
+        {
+          cell_t *buf[2] = {tables[p], tables[1 - p]};
+          uint64_t m     = 0;
+          unsigned done;
+
+#pragma omp atomic read
+          done = res;
+          if (!done)
+            m = diamond_do_tile (ty, tx, k, buf, omp_get_thread_num ());
+
+#pragma omp critical(diamond)
+          {
+            mask[b] |= m;
+
+            // The board is stable from the first generation without any
+            // change. Blocks complete in order, and tasks are only skipped
+            // in blocks following the one which set res.
+            if (--left[b] == 0 && (~mask[b] & (~(uint64_t)0 >> (64 - k))) &&
+                res == 0)
+              res = it + __builtin_ctzll (~mask[b]);
+          }
+        }
+      }
+  }
+
+  if (torus || nb_iter % 2)
+    swap_tables ();
+
+  free (left);
+  free (mask);
+  free (dep);
+
+  return res;
+}
+
+///////////////////////////// In-place version (inplace)
+// Suggested cmdline:
+// ./run -k life -v inplace -s 8192 -ts 64 -a random -n -i 100
+//
+// Only one table is allocated, and cells are overwritten with their next
+// state. The board is cut into bands of TILE_SIZE rows, computed in parallel.
+// Inside a band, the previous states of the row being computed and of the row
+// above it are kept in two rolling row buffers. Rows of a band which are read
+// by the neighbouring bands (its first and last rows) are saved before any
+// band is computed.
+
+static cell_t **inplace_rows = NULL; // per thread: two rolling rows
+static cell_t *inplace_edges = NULL; // per band: its first and last rows
+
+// Saved copy of the first (edge = 0) or last (edge = 1) row of band b, frame
+// columns included
+static inline cell_t *inplace_edge (int b, int edge)
+{
+  return inplace_edges + ((size_t)b * 2 + edge) * PAD_DIM + 1;
+}
+
+static void inplace_init (void)
+{
+  inplace_rows  = calloc (omp_get_max_threads (), sizeof (cell_t *));
+  inplace_edges = malloc ((size_t)NB_TILE * 2 * PAD_DIM * sizeof (cell_t));
+}
+
+// Band b, whose edges are saved, in the current table. Returns 1 if a cell
+// changed.
+rule_inline int inplace_do_band_rule (int b, cell_t *buf, unsigned born,
+                                      unsigned survive)
+{
+  const int y0 = b * TILE_SIZE, y1 = min (y0 + TILE_SIZE, DIM);
+  // Row y0 - 1 is in the frame or in the band above
+  const cell_t *restrict up =
+      b == 0 ? &cur_table (-1, 0) : inplace_edge (b - 1, 1);
+  cell_t diff = 0;
+
+  for (int i = y0; i < y1; i++) {
+    cell_t *restrict mid = buf + (i % 2) * PAD_DIM + 1;
+    const cell_t *restrict down =
+        i + 1 < y1 || i + 1 == DIM ? &cur_table (i + 1, 0)
+                                   : inplace_edge (b + 1, 0);
+    cell_t *restrict out = &cur_table (i, 0);
+
+    memcpy (mid - 1, out - 1, PAD_DIM * sizeof (cell_t));
+
+    diff |= row_next (up, mid, down, out, 0, DIM, born, survive);
+
+    up = mid;
+  }
+
+  return diff != 0;
+}
+
+static int inplace_do_band (int b, int who)
+{
+  int diff;
+
+  if (inplace_rows[who] == NULL)
+    inplace_rows[who] = malloc (2 * PAD_DIM * sizeof (cell_t));
+
+  monitoring_start_tile (who);
+
+  diff = rule_dispatch (inplace_do_band_rule, b, inplace_rows[who]);
+
+  monitoring_end_tile (0, b * TILE_SIZE, DIM,
+                       min (TILE_SIZE, DIM - b * TILE_SIZE), who);
+
+  return diff;
+}
+
+unsigned life_compute_inplace (unsigned nb_iter)
+{
+  if (inplace_rows == NULL)
+    inplace_init ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    if (torus)
+      torus_refresh ();
+
+#pragma omp parallel
+    {
+#pragma omp for
+      for (int b = 0; b < NB_TILE; b++) {
+        const int y0 = b * TILE_SIZE, y1 = min (y0 + TILE_SIZE, DIM);
+
+        memcpy (inplace_edge (b, 0) - 1, &cur_table (y0, -1),
+                PAD_DIM * sizeof (cell_t));
+        memcpy (inplace_edge (b, 1) - 1, &cur_table (y1 - 1, -1),
+                PAD_DIM * sizeof (cell_t));
+      }
+
+#pragma omp for schedule(dynamic, 1) reduction(| : change)
+      for (int b = 0; b < NB_TILE; b++)
+        change |= inplace_do_band (b, omp_get_thread_num ());
+    }
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Out-of-core version (stream)
+// Suggested cmdline:
+// LIFE_STREAM_DIR=/scratch ./run -k life -v stream -s 65536 -ts 256 -a random -n -i 10
+//
+// The current and next tables are files in LIFE_STREAM_DIR (default: current
+// directory), unlinked as soon as they are created, so that the board does not
+// have to fit in memory. Each generation streams the board in bands of
+// TILE_SIZE rows: band b and its two border rows are read with a single pread,
+// computed with row_next, and written back with a single
+// pwrite. Reading band b + 1 and writing band b - 1 overlap the computation of
+// band b. Both files are also mapped (MAP_SHARED) so that drawing and
+// refreshing the image go through the usual cur_table accessors.
+//
+// Images are not out-of-core: they are mapped without reserving huge pages
+// (see img_data_lazy), so that they only take memory once painted. Display,
+// thumbnails and dumps are refused above STREAM_MAX_IMG_DIM, where painting
+// the image would need more than 1 GiB per image.
+#define STREAM_MAX_IMG_DIM 16384
+
+static cell_t *stream_in[2], *stream_out[2]; // double buffers
+
+static void stream_init (void)
+{
+  const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+  char *dir         = getenv ("LIFE_STREAM_DIR");
+  cell_t *map[2];
+
+  if (stream_fd[0] != -1)
+    return;
+
+  if (dir == NULL)
+    dir = ".";
+
+  if (do_display && DIM > STREAM_MAX_IMG_DIM)
+    exit_with_error ("The stream variant cannot display boards larger than %d "
+                     "(DIM = %d): use -n",
+                     STREAM_MAX_IMG_DIM, DIM);
+
+  img_data_lazy = 1;
+
+  PRINT_DEBUG ('u', "Streaming 2 x %zu bytes through %s in bands of %d rows\n",
+               size, dir, TILE_SIZE);
+
+  for (int i = 0; i < 2; i++) {
+    char name[1024];
+
+    snprintf (name, sizeof (name), "%s/life-XXXXXX", dir);
+    stream_fd[i] = mkstemp (name);
+    if (stream_fd[i] == -1 || ftruncate (stream_fd[i], size))
+      exit_with_error ("Cannot create table file in %s: %s", dir,
+                       strerror (errno));
+    unlink (name);
+
+    map[i] = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, stream_fd[i],
+                   0);
+    if (map[i] == MAP_FAILED)
+      exit_with_error ("Cannot map table file: %s", strerror (errno));
+
+    stream_in[i]  = malloc ((size_t)(TILE_SIZE + 2) * PAD_DIM * sizeof (cell_t));
+    stream_out[i] = calloc ((size_t)TILE_SIZE * PAD_DIM, sizeof (cell_t));
+  }
+
+  _table           = map[0];
+  _alternate_table = map[1];
+}
+
+static void stream_finalize (void)
+{
+  const size_t size = (size_t)PAD_DIM * PAD_DIM * sizeof (cell_t);
+
+  munmap (_table, size);
+  munmap (_alternate_table, size);
+
+  for (int i = 0; i < 2; i++) {
+    close (stream_fd[i]);
+    stream_fd[i] = -1;
+    free (stream_in[i]);
+    free (stream_out[i]);
+  }
+}
+
+static void stream_refresh_img (void)
+{
+  if (DIM > STREAM_MAX_IMG_DIM)
+    exit_with_error ("The stream variant cannot paint images of boards larger "
+                     "than %d (DIM = %d)",
+                     STREAM_MAX_IMG_DIM, DIM);
+
+  for (int i = 0; i < DIM; i++)
+    for (int j = 0; j < DIM; j++)
+      cur_img (i, j) = cur_table (i, j) * color;
+}
+
+static void stream_pread (int fd, cell_t *buf, int y, int nb_rows)
+{
+  size_t len  = (size_t)nb_rows * PAD_DIM * sizeof (cell_t);
+  off_t where = (off_t)(y + 1) * PAD_DIM * sizeof (cell_t);
+
+  while (len > 0) {
+    const ssize_t n = pread (fd, buf, len, where);
+
+    if (n <= 0)
+      exit_with_error ("Cannot read table file: %s",
+                       n ? strerror (errno) : "unexpected end of file");
+    buf += n;
+    len -= n;
+    where += n;
+  }
+}
+
+static void stream_pwrite (int fd, const cell_t *buf, int y, int nb_rows)
+{
+  size_t len  = (size_t)nb_rows * PAD_DIM * sizeof (cell_t);
+  off_t where = (off_t)(y + 1) * PAD_DIM * sizeof (cell_t);
+
+  while (len > 0) {
+    const ssize_t n = pwrite (fd, buf, len, where);
+
+    if (n <= 0)
+      exit_with_error ("Cannot write table file: %s", strerror (errno));
+    buf += n;
+    len -= n;
+    where += n;
+  }
+}
+
+// Reads rows y0 - 1 to y0 + h of the current table, frame columns included
+static void stream_read_band (int b, cell_t *buf)
+{
+  const int y0 = b * TILE_SIZE, h = min (TILE_SIZE, DIM - y0);
+
+  stream_pread (stream_fd[0], buf, y0 - 1, h + 2);
+
+  if (torus) {
+    if (y0 == 0)
+      stream_pread (stream_fd[0], buf, DIM - 1, 1);
+    if (y0 + h == DIM)
+      stream_pread (stream_fd[0], buf + (size_t)(h + 1) * PAD_DIM, 0, 1);
+
+    for (int i = 0; i < h + 2; i++) {
+      buf[(size_t)i * PAD_DIM]           = buf[(size_t)i * PAD_DIM + DIM];
+      buf[(size_t)i * PAD_DIM + DIM + 1] = buf[(size_t)i * PAD_DIM + 1];
+    }
+  }
+}
+
+static void stream_write_band (int b, const cell_t *buf)
+{
+  const int y0 = b * TILE_SIZE;
+
+  stream_pwrite (stream_fd[1], buf, y0, min (TILE_SIZE, DIM - y0));
+}
+
+// Whole row given with its neighbours and its frame, returns 1 if a cell
+// changed
+static int stream_do_row (const cell_t *above, const cell_t *row,
+                          const cell_t *below, cell_t *out)
+{
+  return rule_dispatch (row_next, above, row, below, out, 1, DIM + 1) != 0;
+}
+
+static void stream_swap_tables (void)
+{
+  const int fd = stream_fd[0];
+
+  stream_fd[0] = stream_fd[1];
+  stream_fd[1] = fd;
+  swap_tables ();
+}
+
+unsigned life_compute_stream (unsigned nb_iter)
+{
+  const int nb_bands = NB_TILE;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    stream_read_band (0, stream_in[0]);
+
+#pragma omp parallel
+#pragma omp single
+    for (int b = 0; b < nb_bands; b++) {
+      const int y0 = b * TILE_SIZE, h = min (TILE_SIZE, DIM - y0);
+      const cell_t *in = stream_in[b % 2];
+      cell_t *out      = stream_out[b % 2];
+
+      if (b + 1 < nb_bands)
+#pragma omp task
+        stream_read_band (b + 1, stream_in[(b + 1) % 2]);
+
+      if (b > 0)
+#pragma omp task
+        stream_write_band (b - 1, stream_out[(b - 1) % 2]);
+
+#pragma omp taskloop grainsize(8)
+      for (int i = 0; i < h; i++) {
+        const int who __attribute__ ((unused)) = omp_get_thread_num ();
+        const cell_t *row = in + (size_t)(i + 1) * PAD_DIM;
+
+        monitoring_start_tile (who);
+
+        if (stream_do_row (row - PAD_DIM, row, row + PAD_DIM,
+                           out + (size_t)i * PAD_DIM)) {
+#pragma omp atomic write
+          change = 1;
+        }
+
+        monitoring_end_tile (0, y0 + i, DIM, 1, who);
+      }
+
+      // Buffers are reused at the next band
+#pragma omp taskwait
+    }
+
+    stream_write_band (nb_bands - 1, stream_out[(nb_bands - 1) % 2]);
+    stream_swap_tables ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Tile-major versions (blocked)
+// Suggested cmdline:
+// ./run -k life -v blocked_omp_tiled -s 16384 -ts 64 -a random -n -i 100
+//
+// Tiles are stored contiguously (see blk_tile), so that computing a tile
+// touches a few pages only. Before a tile is computed, its halo is refreshed
+// from the neighbouring tiles of the current table: only the interior of
+// tiles is written to the next table, so tiles are independent.
+
+static void blk_init (void)
+{
+  if (_blk_table == NULL) {
+    const size_t size = (size_t)NB_TILE * NB_TILE * BLK_CELLS * sizeof (cell_t);
+
+    PRINT_DEBUG ('u', "Memory footprint = 2 x %zu bytes\n", size);
+
+    _blk_table           = huge_alloc (size);
+    _blk_alternate_table = huge_alloc (size);
+    if (_blk_table == NULL || _blk_alternate_table == NULL)
+      exit_with_error ("Cannot allocate blocked tables: mmap failed");
+  }
+}
+
+static void blk_finalize (void)
+{
+  const size_t size = (size_t)NB_TILE * NB_TILE * BLK_CELLS * sizeof (cell_t);
+
+  huge_free (_blk_table, size);
+  huge_free (_blk_alternate_table, size);
+}
+
+static void blk_refresh_img (void)
+{
+  for (int y = 0; y < DIM; y += TILE_SIZE)
+    for (int x = 0; x < DIM; x += TILE_SIZE) {
+      const cell_t *b = blk_tile (_blk_table, y / TILE_SIZE, x / TILE_SIZE);
+
+      for (int i = 0; i < min (TILE_SIZE, DIM - y); i++)
+        for (int j = 0; j < min (TILE_SIZE, DIM - x); j++)
+          cur_img (y + i, x + j) = b[(i + 1) * BLK_SIDE + j + 1] * color;
+    }
+}
+
+static inline void blk_swap_tables (void)
+{
+  cell_t *tmp = _blk_table;
+
+  _blk_table           = _blk_alternate_table;
+  _blk_alternate_table = tmp;
+}
+
+// Cell (y, x) of the current table, where y and x may be out of the board by
+// one cell: NULL if it is dead
+static inline const cell_t *blk_neighbour (int y, int x)
+{
+  if (torus)
+    return blk_cell (_blk_table, torus_wrap (y), torus_wrap (x));
+
+  if (y < 0 || y >= DIM || x < 0 || x >= DIM)
+    return NULL;
+
+  return blk_cell (_blk_table, y, x);
+}
+
+// Copies into the halo of a tile of the current table the cells around it
+static void blk_load_halo (int ty, int tx)
+{
+  const int y = ty * TILE_SIZE, x = tx * TILE_SIZE;
+  const int w = min (TILE_SIZE, DIM - x), h = min (TILE_SIZE, DIM - y);
+  cell_t *b = blk_tile (_blk_table, ty, tx);
+
+  // Rows above and below: w contiguous cells of a single tile
+  for (int r = -1; r <= h; r += h + 1) {
+    const cell_t *src = blk_neighbour (y + r, x);
+
+    if (src == NULL)
+      memset (b + (r + 1) * BLK_SIDE + 1, 0, w);
+    else
+      memcpy (b + (r + 1) * BLK_SIDE + 1, src, w);
+  }
+
+  // Columns on the left and on the right, and corners
+  for (int c = -1; c <= w; c += w + 1) {
+    const cell_t *src = blk_neighbour (y, x + c);
+
+    for (int i = 0; i < h; i++)
+      b[(i + 1) * BLK_SIDE + c + 1] = src == NULL ? 0 : src[i * BLK_SIDE];
+
+    for (int r = -1; r <= h; r += h + 1) {
+      const cell_t *corner = blk_neighbour (y + r, x + c);
+
+      b[(r + 1) * BLK_SIDE + c + 1] = corner == NULL ? 0 : *corner;
+    }
+  }
+}
+
+// Tile (ty, tx), whose halo is loaded. Returns 1 if a cell changed.
+rule_inline int blk_do_tile_rule (int ty, int tx, unsigned born,
+                                  unsigned survive)
+{
+  const int w = min (TILE_SIZE, DIM - tx * TILE_SIZE);
+  const int h = min (TILE_SIZE, DIM - ty * TILE_SIZE);
+  const cell_t *src = blk_tile (_blk_table, ty, tx);
+  cell_t *dst       = blk_tile (_blk_alternate_table, ty, tx);
+  cell_t diff       = 0;
+
+  for (int i = 1; i <= h; i++)
+    diff |= row_next (src + (i - 1) * BLK_SIDE, src + i * BLK_SIDE,
+                      src + (i + 1) * BLK_SIDE, dst + i * BLK_SIDE, 1, w + 1,
+                      born, survive);
+
+  return diff != 0;
+}
+
+static int blk_do_tile (int ty, int tx, int who)
+{
+  const int x __attribute__ ((unused)) = tx * TILE_SIZE;
+  const int y __attribute__ ((unused)) = ty * TILE_SIZE;
+  int diff;
+
+  monitoring_start_tile (who);
+
+  blk_load_halo (ty, tx);
+  diff = rule_dispatch (blk_do_tile_rule, ty, tx);
+
+  monitoring_end_tile (x, y, min (TILE_SIZE, DIM - x), min (TILE_SIZE, DIM - y),
+                       who);
+
+  return diff;
+}
+
+unsigned life_compute_blocked_tiled (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    for (unsigned t = 0; t < NB_TILE * NB_TILE; t++)
+      change |= blk_do_tile (tile_at (t) / NB_TILE, tile_at (t) % NB_TILE, 0);
+
+    blk_swap_tables ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_blocked_omp_tiled (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    if (tile_affinity)
+#pragma omp parallel reduction(| : change)
+    {
+      const tile_span_t s = tile_spans[omp_get_thread_num ()];
+
+      for (unsigned t = s.begin; t < s.end; t++)
+        change |= blk_do_tile (tile_at (t) / NB_TILE, tile_at (t) % NB_TILE,
+                               omp_get_thread_num ());
+    }
+    else
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : change)
+      for (unsigned t = 0; t < NB_TILE * NB_TILE; t++)
+        change |= blk_do_tile (tile_at (t) / NB_TILE, tile_at (t) % NB_TILE,
+                               omp_get_thread_num ());
+
+    blk_swap_tables ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Lookup-table versions (lut)
+// Suggested cmdline:
+// ./run -k life -v lut_omp_tiled -s 4096 -ts 64 -a random -n -i 100
+//
+// Cells are computed by 2x2 blocks. The 4x4 neighbourhood of a block is
+// packed into a 16-bit index: row k of the neighbourhood is the nibble at
+// bits 12 - 4k, its leftmost cell being the most significant bit. The index
+// is rolled along the row, two columns at a time, and the next state of the
+// inner 2x2 is read from a 64 KiB table computed by lut_init from the rules.
+
+static uint8_t lut_table[1 << 16];
+
+static inline unsigned lut_bit (unsigned idx, int i, int j)
+{
+  return (idx >> (15 - 4 * i - j)) & 1;
+}
+
+static void lut_init (void)
+{
+  for (unsigned idx = 0; idx < (1 << 16); idx++) {
+    unsigned res = 0;
+
+    for (int i = 1; i <= 2; i++)
+      for (int j = 1; j <= 2; j++) {
+        unsigned n = 0;
+
+        for (int di = -1; di <= 1; di++)
+          for (int dj = -1; dj <= 1; dj++)
+            n += lut_bit (idx, i + di, j + dj);
+
+        res = (res << 1) | rules[lut_bit (idx, i, j)][n];
+      }
+
+    lut_table[idx] = res;
+  }
+
+  PRINT_DEBUG ('u', "Lookup table of %zu bytes computed\n", sizeof (lut_table));
+}
+
+// Columns of the 4 rows to add to the right of the index
+static inline unsigned lut_cols (const cell_t *r[4], int x)
+{
+  return r[0][x] << 13 | r[0][x + 1] << 12 | r[1][x] << 9 |
+         r[1][x + 1] << 8 | r[2][x] << 5 | r[2][x + 1] << 4 |
+         r[3][x] << 1 | r[3][x + 1];
+}
+
+// Computes rows y and y + 1 (only y if !two_rows) for columns [x_begin,
+// x_end). Returns a non-zero value if a cell changed.
+static unsigned lut_do_rows (int y, int two_rows, int x_begin, int x_end)
+{
+  // Row y + 2 only matters for row y + 1. When the latter is not computed,
+  // the former may be out of the table.
+  const cell_t *r[4] = {&cur_table (y - 1, 0), &cur_table (y, 0),
+                        &cur_table (y + 1, 0),
+                        &cur_table (two_rows ? y + 2 : y + 1, 0)};
+  cell_t *out0 = &next_table (y, 0), *out1 = &next_table (y + 1, 0);
+  unsigned idx = lut_cols (r, x_begin - 1); // columns x - 1 and x
+  unsigned diff = 0;
+  int x;
+
+  // Columns x + 1 and x + 2 always exist while x + 1 < x_end <= DIM
+  for (x = x_begin; x + 1 < x_end; x += 2) {
+    idx = ((idx << 2) & 0xCCCC) | lut_cols (r, x + 1);
+
+    const unsigned res = lut_table[idx];
+
+    diff |= res ^ ((idx >> 7) & 0xC) ^ ((idx >> 5) & 0x3);
+
+    out0[x]     = res >> 3;
+    out0[x + 1] = (res >> 2) & 1;
+    if (two_rows) {
+      out1[x]     = (res >> 1) & 1;
+      out1[x + 1] = res & 1;
+    }
+  }
+
+  // Odd width: the last block only has its left column inside [x_begin,
+  // x_end), and column x + 2 may be out of the table
+  if (x < x_end) {
+    const unsigned right =
+        x + 2 <= DIM ? lut_cols (r, x + 1)
+                     : (lut_cols (r, x) & 0x5555) << 1; // column x + 2 is 0
+    idx                = ((idx << 2) & 0xCCCC) | right;
+
+    const unsigned res = lut_table[idx] & 0xA;
+
+    diff |= res ^ ((idx >> 7) & 0x8) ^ ((idx >> 5) & 0x2);
+
+    out0[x] = res >> 3;
+    if (two_rows)
+      out1[x] = (res >> 1) & 1;
+  }
+
+  if (!two_rows)
+    diff &= 0xC;
+
+  return diff;
+}
+
+static unsigned lut_do_tile_reg (int x, int y, int width, int height)
+{
+  const int x_end = min (x + width, DIM), y_end = min (y + height, DIM);
+  unsigned diff   = 0;
+
+  for (int i = y; i < y_end; i += 2)
+    diff |= lut_do_rows (i, i + 1 < y_end, x, x_end);
+
+  return diff;
+}
+
+static unsigned lut_do_tile (int x, int y, int width, int height, int who)
+{
+  unsigned diff;
+
+  monitoring_start_tile (who);
+
+  diff = lut_do_tile_reg (x, y, width, height);
+
+  monitoring_end_tile (x, y, width, height, who);
+
+  return diff;
+}
+
+unsigned life_compute_lut (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned diff = 0;
+
+    if (torus)
+      torus_refresh ();
+
+    for (int y = 0; y < DIM; y += TILE_SIZE)
+      for (int x = 0; x < DIM; x += TILE_SIZE)
+        diff |= lut_do_tile (x, y, TILE_SIZE, TILE_SIZE, 0);
+
+    swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_lut_omp_tiled (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned diff = 0;
+
+    if (torus)
+      torus_refresh ();
+
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : diff)
+    for (unsigned t = 0; t < NB_TILE * NB_TILE; t++)
+      diff |= lut_do_tile (tile_at (t) % NB_TILE * TILE_SIZE,
+                           tile_at (t) / NB_TILE * TILE_SIZE, TILE_SIZE,
+                           TILE_SIZE, omp_get_thread_num ());
+
+    swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Sparse frontier version (frontier)
+// Suggested cmdline:
+// ./run -k life -v frontier -s 16384 -a diehard -n -i 1000
+//
+// The frontier lists the cells that changed at the previous generation. Only
+// them and their neighbours may change, so only these cells are computed: the
+// work per generation depends on the activity, not on the board size. A cell
+// is claimed by the first thread setting its fr_seen byte, and threads append
+// changed cells to their own buffer, concatenated at the end of the
+// generation. Cells which are not computed have the same state in both
+// tables, so they are never copied.
+
+#define FR_FRAME 2 // fr_seen value of frame cells
+
+typedef struct
+{
+  uint32_t *cells;
+  size_t size, capacity, offset;
+} fr_buffer_t;
+
+static uint32_t *fr_cells = NULL; // indexes in the tables, frame included
+static size_t fr_size = 0, fr_capacity = 0;
+static uint8_t *fr_seen        = NULL;
+static fr_buffer_t *fr_buffers = NULL; // one per thread
+
+static inline uint32_t fr_index (int y, int x)
+{
+  return table_cell (_table, y, x) - _table;
+}
+
+static void fr_push (fr_buffer_t *b, uint32_t c)
+{
+  if (b->size == b->capacity) {
+    b->capacity = max (2 * b->capacity, 1024);
+    b->cells    = realloc (b->cells, b->capacity * sizeof (uint32_t));
+  }
+  b->cells[b->size++] = c;
+}
+
+static void fr_init (void)
+{
+  const size_t size = (size_t)PAD_DIM * PAD_DIM;
+
+  if (size > UINT32_MAX)
+    exit_with_error ("DIM (%d) is too large for the frontier variant", DIM);
+
+  fr_buffers = calloc (omp_get_max_threads (), sizeof (fr_buffer_t));
+  fr_seen    = calloc (size, 1);
+
+  for (int i = -1; i <= (int)DIM; i++)
+    fr_seen[fr_index (i, -1)] = fr_seen[fr_index (i, DIM)] =
+        fr_seen[fr_index (-1, i)] = fr_seen[fr_index (DIM, i)] = FR_FRAME;
+
+  // Both tables hold the initial board, and every living cell may have
+  // living neighbours at next generation
+  memcpy (_alternate_table, _table, size * sizeof (cell_t));
+  for (int i = 0; i < DIM; i++)
+    for (int j = 0; j < DIM; j++)
+      if (cur_table (i, j))
+        fr_push (fr_buffers, fr_index (i, j));
+
+  fr_cells    = fr_buffers[0].cells;
+  fr_size     = fr_buffers[0].size;
+  fr_capacity = fr_buffers[0].capacity;
+  fr_buffers[0] = (fr_buffer_t){NULL, 0, 0, 0};
+}
+
+// Index of the k-th cell of the 3x3 neighbourhood of c, or -1 if it is out of
+// the board. On a torus, frame cells are mapped to the opposite edge.
+static inline int64_t fr_neighbour (uint32_t c, int k)
+{
+  const int64_t n = c + (k / 3 - 1) * (int64_t)PAD_DIM + k % 3 - 1;
+
+  if (fr_seen[n] != FR_FRAME)
+    return n;
+
+  if (!torus)
+    return -1;
+
+  return fr_index (torus_wrap (n / PAD_DIM - 1), torus_wrap (n % PAD_DIM - 1));
+}
+
+// Computes cell c, returns 1 if it changed
+rule_inline int fr_compute_cell (uint32_t c, unsigned born, unsigned survive)
+{
+  const int pad     = PAD_DIM;
+  const cell_t *in  = _table + c;
+  const cell_t n    = in[-pad - 1] + in[-pad] + in[-pad + 1] + in[-1] + in[0] +
+                   in[1] + in[pad - 1] + in[pad] + in[pad + 1];
+
+  _alternate_table[c] = rule_next (in[0], n, born, survive);
+
+  return _alternate_table[c] != in[0];
+}
+
+// Neighbourhoods of the frontier cells, shared among the threads of the
+// enclosing parallel region. Cells which changed are pushed into b.
+rule_inline void fr_visit_rule (fr_buffer_t *b, uint32_t *c_min,
+                                uint32_t *c_max, unsigned born,
+                                unsigned survive)
+{
+#pragma omp for schedule(dynamic, 256)
+  for (size_t i = 0; i < fr_size; i++) {
+    const uint32_t c = fr_cells[i];
+
+    for (int k = 0; k < 9; k++) {
+      const int64_t n = fr_neighbour (c, k);
+
+      if (n < 0 || __atomic_load_n (&fr_seen[n], __ATOMIC_RELAXED) ||
+          __atomic_exchange_n (&fr_seen[n], 1, __ATOMIC_RELAXED))
+        continue;
+
+      if (fr_compute_cell (n, born, survive))
+        fr_push (b, n);
+    }
+
+    *c_min = min (*c_min, c);
+    *c_max = max (*c_max, c);
+  }
+}
+
+unsigned life_compute_frontier (unsigned nb_iter)
+{
+  if (fr_buffers == NULL)
+    fr_init ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    if (torus)
+      torus_refresh ();
+
+#pragma omp parallel
+    {
+      const int who  = omp_get_thread_num ();
+      fr_buffer_t *b = fr_buffers + who;
+      uint32_t c_min = UINT32_MAX, c_max = 0;
+
+      b->size = 0;
+
+      monitoring_start_tile (who);
+
+      rule_dispatch (fr_visit_rule, b, &c_min, &c_max);
+
+      // Monitoring shows the rows of the frontier handled by the thread
+      if (c_min <= c_max)
+        monitoring_end_tile (0, c_min / PAD_DIM - 1, DIM,
+                             c_max / PAD_DIM - c_min / PAD_DIM + 1, who);
+      else
+        monitoring_end_tile (0, 0, 0, 0, who);
+
+      // Claimed cells are released for next generation
+#pragma omp for schedule(static)
+      for (size_t i = 0; i < fr_size; i++)
+        for (int k = 0; k < 9; k++) {
+          const int64_t n = fr_neighbour (fr_cells[i], k);
+
+          if (n >= 0)
+            __atomic_store_n (&fr_seen[n], 0, __ATOMIC_RELAXED);
+        }
+
+#pragma omp single
+      {
+        fr_size = 0;
+        for (int t = 0; t < omp_get_num_threads (); t++) {
+          fr_buffers[t].offset = fr_size;
+          fr_size += fr_buffers[t].size;
+        }
+
+        if (fr_size > fr_capacity) {
+          fr_capacity = max (fr_size, 2 * fr_capacity);
+          fr_cells    = realloc (fr_cells, fr_capacity * sizeof (uint32_t));
+        }
+      }
+
+      memcpy (fr_cells + b->offset, b->cells, b->size * sizeof (uint32_t));
+    }
+
+    swap_tables ();
+
+    if (fr_size == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Bit-packed versions (bitboard)
+// Suggested cmdline:
+// ./run -k life -v bitboard_omp -s 32768 -a random -n -i 100
+//
+// The board is stored as rows of 64-bit words. The eight neighbours of 64
+// cells are summed at once with bitwise full adders, giving a bit-sliced
+// 4-bit count per cell.
+
+static void bb_init (void)
+{
+  if (_bb_table == NULL) {
+    const size_t size = (size_t)(DIM + 2) * BB_STRIDE * sizeof (bb_word_t);
+
+    PRINT_DEBUG ('u', "Memory footprint = 2 x %zu bytes\n", size);
+
+    _bb_table           = huge_alloc (size);
+    _bb_alternate_table = huge_alloc (size);
+    if (_bb_table == NULL || _bb_alternate_table == NULL)
+      exit_with_error ("Cannot allocate bitboard tables: mmap failed");
+  }
+
+  // The last word of a row must end with cell DIM - 1 to wrap around
+  if (torus && DIM % BB_BITS)
+    exit_with_error ("DIM (%d) is not a multiple of %d: torus mode is not "
+                     "supported by bitboard variants",
+                     DIM, BB_BITS);
+}
+
+static void bb_finalize (void)
+{
+  const size_t size = (size_t)(DIM + 2) * BB_STRIDE * sizeof (bb_word_t);
+
+  huge_free (_bb_table, size);
+  huge_free (_bb_alternate_table, size);
+  _bb_table = _bb_alternate_table = NULL;
+}
+
+static void bb_refresh_img (void)
+{
+  for (int i = 0; i < DIM; i++)
+    for (int j = 0; j < DIM; j++)
+      cur_img (i, j) = ((cur_bb (i, j / BB_BITS) >> (j % BB_BITS)) & 1) * color;
+}
+
+static inline void bb_swap_tables (void)
+{
+  bb_word_t *tmp = _bb_table;
+
+  _bb_table           = _bb_alternate_table;
+  _bb_alternate_table = tmp;
+}
+
+// Same as torus_refresh for the bitboard
+static void bb_torus_refresh (void)
+{
+  for (int i = 0; i < DIM; i++) {
+    bb_word_t *r = bb_row (_bb_table, i);
+
+    r[-1]       = r[BB_WORDS - 1];
+    r[BB_WORDS] = r[0];
+  }
+
+  memcpy (bb_row (_bb_table, -1) - 1, bb_row (_bb_table, DIM - 1) - 1,
+          BB_STRIDE * sizeof (bb_word_t));
+  memcpy (bb_row (_bb_table, DIM) - 1, bb_row (_bb_table, 0) - 1,
+          BB_STRIDE * sizeof (bb_word_t));
+}
+
+// When DIM is not a multiple of 64, bits of the last word beyond DIM belong to
+// the dead frame and must stay at zero
+static inline bb_word_t bb_border_mask (int w)
+{
+  return (w == BB_WORDS - 1 && DIM % BB_BITS)
+             ? ((bb_word_t)1 << (DIM % BB_BITS)) - 1
+             : ~(bb_word_t)0;
+}
+
+// Neighbours at x-1 (resp. x+1) of the 64 cells of word w
+static inline bb_word_t bb_west (const bb_word_t *r, int w)
+{
+  return (r[w] << 1) | (r[w - 1] >> (BB_BITS - 1));
+}
+
+static inline bb_word_t bb_east (const bb_word_t *r, int w)
+{
+  return (r[w] >> 1) | (r[w + 1] << (BB_BITS - 1));
+}
+
+// Next state of 64 cells, given the nine words holding their neighbourhood
+rule_inline bb_word_t bb_life_word (bb_word_t ul, bb_word_t u, bb_word_t ur,
+                                    bb_word_t l, bb_word_t me, bb_word_t r,
+                                    bb_word_t dl, bb_word_t d, bb_word_t dr,
+                                    unsigned born, unsigned survive)
+{
+  // 2-bit sums of the rows above and below, 2-bit sum of left and right
+  const bb_word_t u0 = ul ^ u ^ ur, u1 = (ul & u) | (ur & (ul ^ u));
+  const bb_word_t d0 = dl ^ d ^ dr, d1 = (dl & d) | (dr & (dl ^ d));
+  const bb_word_t m0 = l ^ r, m1 = l & r;
+
+  // Bit-sliced count n = s0 + 2 * s1 + 4 * s2 + 8 * s3
+  const bb_word_t s0 = u0 ^ d0 ^ m0, c0 = (u0 & d0) | (m0 & (u0 ^ d0));
+  const bb_word_t x = u1 ^ d1 ^ m1, cx = (u1 & d1) | (m1 & (u1 ^ d1));
+  const bb_word_t s1 = x ^ c0, cy = x & c0;
+  const bb_word_t s2 = cx ^ cy, s3 = cx & cy;
+
+  // Sum of the n == k terms of the rule. With compile-time masks, the other
+  // terms vanish (B3/S23 gives n == 3, or n == 2 and alive).
+  bb_word_t res = 0;
+
+  for (unsigned k = 0; k <= 8; k++) {
+    const bb_word_t b = -(bb_word_t)((born >> k) & 1);
+    const bb_word_t s = -(bb_word_t)((survive >> k) & 1);
+    const bb_word_t eq = (k & 1 ? s0 : ~s0) & (k & 2 ? s1 : ~s1) &
+                         (k & 4 ? s2 : ~s2) & (k & 8 ? s3 : ~s3);
+
+    res |= eq & ((b & ~me) | (s & me));
+  }
+
+  return res;
+}
+
+rule_inline bb_word_t bb_next_word (const bb_word_t *up, const bb_word_t *mid,
+                                    const bb_word_t *down, int w, unsigned born,
+                                    unsigned survive)
+{
+  return bb_life_word (bb_west (up, w), up[w], bb_east (up, w),
+                       bb_west (mid, w), mid[w], bb_east (mid, w),
+                       bb_west (down, w), down[w], bb_east (down, w), born,
+                       survive);
+}
+
+// Computes words [w_begin, w_end[ of row y, returns the changed bits
+rule_inline bb_word_t bb_do_row_rule (int y, int w_begin, int w_end,
+                                      unsigned born, unsigned survive)
+{
+  const bb_word_t *up = bb_row (_bb_table, y - 1);
+  const bb_word_t *mid = bb_row (_bb_table, y);
+  const bb_word_t *down = bb_row (_bb_table, y + 1);
+  bb_word_t *out = bb_row (_bb_alternate_table, y);
+  bb_word_t diff = 0;
+
+  for (int w = w_begin; w < w_end; w++) {
+    const bb_word_t n =
+        bb_next_word (up, mid, down, w, born, survive) & bb_border_mask (w);
+
+    diff |= n ^ mid[w];
+    out[w] = n;
+  }
+
+  return diff;
+}
+
+static bb_word_t bb_do_row (int y, int w_begin, int w_end)
+{
+  return rule_dispatch (bb_do_row_rule, y, w_begin, w_end);
+}
+
+static bb_word_t bb_do_tile_reg (int x, int y, int width, int height)
+{
+  const int y_end   = min (y + height, DIM);
+  const int w_begin = x / BB_BITS, w_end = min ((x + width) / BB_BITS, BB_WORDS);
+  bb_word_t diff = 0;
+
+  for (int i = y; i < y_end; i++)
+    diff |= bb_do_row (i, w_begin, w_end);
+
+  return diff;
+}
+
+static bb_word_t bb_do_tile (int x, int y, int width, int height, int who)
+{
+  bb_word_t diff;
+
+  monitoring_start_tile (who);
+
+  diff = bb_do_tile_reg (x, y, width, height);
+
+  monitoring_end_tile (x, y, width, height, who);
+
+  return diff;
+}
+
+static void bb_check_tile_size (void)
+{
+  if (TILE_SIZE % BB_BITS)
+    exit_with_error ("TILE_SIZE (%d) is not a multiple of %d", TILE_SIZE,
+                     BB_BITS);
+}
+
+unsigned life_compute_bitboard (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    bb_word_t diff = 0;
+
+    if (torus)
+      bb_torus_refresh ();
+
+    monitoring_start_tile (0);
+
+    for (int i = 0; i < DIM; i++)
+      diff |= bb_do_row (i, 0, BB_WORDS);
+
+    monitoring_end_tile (0, 0, DIM, DIM, 0);
+
+    bb_swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_bitboard_omp (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    bb_word_t diff = 0;
+
+    if (torus)
+      bb_torus_refresh ();
+
+#pragma omp parallel for schedule(static) reduction(| : diff)
+    for (int i = 0; i < DIM; i++)
+      diff |= bb_do_row (i, 0, BB_WORDS);
+
+    bb_swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_bitboard_tiled (unsigned nb_iter)
+{
+  bb_check_tile_size ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    bb_word_t diff = 0;
+
+    if (torus)
+      bb_torus_refresh ();
+
+    for (int y = 0; y < DIM; y += TILE_SIZE)
+      for (int x = 0; x < DIM; x += TILE_SIZE)
+        diff |= bb_do_tile (x, y, TILE_SIZE, TILE_SIZE, 0);
+
+    bb_swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_bitboard_omp_tiled (unsigned nb_iter)
+{
+  bb_check_tile_size ();
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    bb_word_t diff = 0;
+
+    if (torus)
+      bb_torus_refresh ();
+
+#pragma omp parallel for schedule(dynamic, 8) reduction(| : diff)
+    for (unsigned t = 0; t < NB_TILE * NB_TILE; t++)
+      diff |= bb_do_tile (tile_at (t) % NB_TILE * TILE_SIZE,
+                          tile_at (t) / NB_TILE * TILE_SIZE, TILE_SIZE,
+                          TILE_SIZE, omp_get_thread_num ());
+
+    bb_swap_tables ();
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Unbounded sparse-tile versions (unbounded)
+// Suggested cmdline:
+// ./run -k life -v unbounded_omp -s 1024 -ts 64 -a guns -i 20000
+//
+// Only tiles holding live cells are allocated, in a hash map indexed by tile
+// coordinates. Each tile is a TILE_SIZE x TILE_SIZE bitboard. Before each
+// generation, a tile is created next to every edge or corner of a tile having
+// live cells on it; tiles left empty after a generation are freed. The
+// universe is unbounded: the DIM x DIM window is a viewport on its top-left
+// corner, and cells crossing the window border keep evolving.
+
+#define UT_WORDS (TILE_SIZE / BB_BITS)
+
+struct ut_tile
+{
+  int64_t ty, tx;            // tile coordinates
+  bb_word_t *cur, *next;     // TILE_SIZE rows of UT_WORDS words
+  struct ut_tile *hnext;     // hash chain
+  struct ut_tile *nbr[3][3]; // neighbours, nbr[1][1] being the tile itself
+  bb_word_t data[];          // storage for cur and next
+};
+
+static ut_tile_t **ut_list = NULL; // allocated tiles
+static size_t ut_nb_tiles = 0, ut_list_size = 0, ut_nb_buckets = 0;
+static bb_word_t *ut_zero_row = NULL;
+
+static inline int64_t floor_div (int64_t a, int64_t b)
+{
+  return a >= 0 ? a / b : -((-a - 1) / b) - 1;
+}
+
+static inline size_t ut_hash (int64_t ty, int64_t tx)
+{
+  const uint64_t h = ((uint64_t)ty * 0x9E3779B97F4A7C15ULL) ^
+                     ((uint64_t)tx * 0xC2B2AE3D27D4EB4FULL);
+
+  return (h ^ (h >> 31)) & (ut_nb_buckets - 1);
+}
+
+static ut_tile_t *ut_find (int64_t ty, int64_t tx)
+{
+  for (ut_tile_t *t = ut_buckets[ut_hash (ty, tx)]; t != NULL; t = t->hnext)
+    if (t->ty == ty && t->tx == tx)
+      return t;
+
+  return NULL;
+}
+
+static void ut_rehash (void)
+{
+  const size_t old_size = ut_nb_buckets;
+  ut_tile_t **old       = ut_buckets;
+
+  ut_nb_buckets = old_size ? 2 * old_size : 1024;
+  ut_buckets    = calloc (ut_nb_buckets, sizeof (ut_tile_t *));
+  if (ut_buckets == NULL)
+    exit_with_error ("Cannot allocate tile hash map");
+
+  for (size_t b = 0; b < old_size; b++)
+    for (ut_tile_t *t = old[b], *next; t != NULL; t = next) {
+      const size_t h = ut_hash (t->ty, t->tx);
+
+      next          = t->hnext;
+      t->hnext      = ut_buckets[h];
+      ut_buckets[h] = t;
+    }
+
+  free (old);
+}
+
+static ut_tile_t *ut_create (int64_t ty, int64_t tx)
+{
+  ut_tile_t *t = ut_find (ty, tx);
+
+  if (t != NULL)
+    return t;
+
+  t = calloc (1, sizeof (ut_tile_t) + 2 * TILE_SIZE * UT_WORDS * sizeof (bb_word_t));
+  if (t == NULL)
+    exit_with_error ("Cannot allocate tile (%ld, %ld)", (long)ty, (long)tx);
+  t->cur  = t->data;
+  t->next = t->data + TILE_SIZE * UT_WORDS;
+  t->ty   = ty;
+  t->tx   = tx;
+
+  if (ut_nb_tiles == ut_list_size) {
+    ut_list_size = ut_list_size ? 2 * ut_list_size : 1024;
+    ut_list      = realloc (ut_list, ut_list_size * sizeof (ut_tile_t *));
+  }
+  ut_list[ut_nb_tiles++] = t;
+
+  if (ut_nb_tiles > ut_nb_buckets)
+    ut_rehash ();
+
+  const size_t h = ut_hash (ty, tx);
+  t->hnext       = ut_buckets[h];
+  ut_buckets[h]  = t;
+
+  return t;
+}
+
+// Removes tile number i of ut_list
+static void ut_free (size_t i)
+{
+  ut_tile_t *t     = ut_list[i];
+  ut_tile_t **prev = &ut_buckets[ut_hash (t->ty, t->tx)];
+
+  while (*prev != t)
+    prev = &(*prev)->hnext;
+  *prev = t->hnext;
+
+  ut_list[i] = ut_list[--ut_nb_tiles];
+
+  free (t);
+}
+
+static inline bb_word_t *ut_row (ut_tile_t *t, int r)
+{
+  return t->cur + r * UT_WORDS;
+}
+
+static void ut_init (void)
+{
+  bb_check_tile_size ();
+
+  if (ut_buckets == NULL) {
+    ut_rehash ();
+    ut_zero_row = calloc (UT_WORDS, sizeof (bb_word_t));
+  }
+}
+
+static void ut_finalize (void)
+{
+  while (ut_nb_tiles > 0)
+    ut_free (ut_nb_tiles - 1);
+
+  free (ut_list);
+  free (ut_buckets);
+  free (ut_zero_row);
+  ut_list    = NULL;
+  ut_buckets = NULL;
+  ut_nb_buckets = ut_list_size = 0;
+}
+
+static void ut_set_cell (int64_t y, int64_t x)
+{
+  ut_tile_t *t = ut_create (floor_div (y, TILE_SIZE), floor_div (x, TILE_SIZE));
+  const int64_t r = y - t->ty * TILE_SIZE, c = x - t->tx * TILE_SIZE;
+
+  ut_row (t, r)[c / BB_BITS] |= (bb_word_t)1 << (c % BB_BITS);
+}
+
+static int ut_get_cell (int64_t y, int64_t x)
+{
+  ut_tile_t *t = ut_find (floor_div (y, TILE_SIZE), floor_div (x, TILE_SIZE));
+
+  if (t == NULL)
+    return 0;
+
+  const int64_t r = y - t->ty * TILE_SIZE, c = x - t->tx * TILE_SIZE;
+
+  return (ut_row (t, r)[c / BB_BITS] >> (c % BB_BITS)) & 1;
+}
+
+static void ut_refresh_img (void)
+{
+  memset (image, 0, (size_t)DIM * DIM * sizeof (uint32_t));
+
+  for (size_t i = 0; i < ut_nb_tiles; i++) {
+    ut_tile_t *t    = ut_list[i];
+    const int64_t y = t->ty * TILE_SIZE, x = t->tx * TILE_SIZE;
+
+    if (y >= DIM || x >= DIM || y + TILE_SIZE <= 0 || x + TILE_SIZE <= 0)
+      continue;
+
+    for (int r = max (0, (int)-y); r < min (TILE_SIZE, (int)(DIM - y)); r++)
+      for (int c = max (0, (int)-x); c < min (TILE_SIZE, (int)(DIM - x)); c++)
+        cur_img (y + r, x + c) =
+            ((ut_row (t, r)[c / BB_BITS] >> (c % BB_BITS)) & 1) * color;
+  }
+}
+
+// Creates the missing neighbours facing live cells on the tile edges
+static void ut_add_neighbours (void)
+{
+  const size_t n          = ut_nb_tiles;
+  const bb_word_t west_b  = 1;
+  const bb_word_t east_b  = (bb_word_t)1 << (BB_BITS - 1);
+
+  for (size_t i = 0; i < n; i++) {
+    ut_tile_t *t = ut_list[i];
+    bb_word_t north = 0, south = 0, west = 0, east = 0;
+
+    for (int w = 0; w < UT_WORDS; w++) {
+      north |= ut_row (t, 0)[w];
+      south |= ut_row (t, TILE_SIZE - 1)[w];
+    }
+    for (int r = 0; r < TILE_SIZE; r++) {
+      west |= ut_row (t, r)[0] & west_b;
+      east |= ut_row (t, r)[UT_WORDS - 1] & east_b;
+    }
+
+    if (north)
+      ut_create (t->ty - 1, t->tx);
+    if (south)
+      ut_create (t->ty + 1, t->tx);
+    if (west)
+      ut_create (t->ty, t->tx - 1);
+    if (east)
+      ut_create (t->ty, t->tx + 1);
+    if (ut_row (t, 0)[0] & west_b)
+      ut_create (t->ty - 1, t->tx - 1);
+    if (ut_row (t, 0)[UT_WORDS - 1] & east_b)
+      ut_create (t->ty - 1, t->tx + 1);
+    if (ut_row (t, TILE_SIZE - 1)[0] & west_b)
+      ut_create (t->ty + 1, t->tx - 1);
+    if (ut_row (t, TILE_SIZE - 1)[UT_WORDS - 1] & east_b)
+      ut_create (t->ty + 1, t->tx + 1);
+  }
+
+  for (size_t i = 0; i < ut_nb_tiles; i++) {
+    ut_tile_t *t = ut_list[i];
+
+    for (int dy = 0; dy < 3; dy++)
+      for (int dx = 0; dx < 3; dx++)
+        t->nbr[dy][dx] = ut_find (t->ty + dy - 1, t->tx + dx - 1);
+  }
+}
+
+// Row r (-1 <= r <= TILE_SIZE) of the neighbourhood of tile t, along with
+// the words just west and east of it
+static inline const bb_word_t *ut_nbr_row (ut_tile_t *t, int r, bb_word_t *west,
+                                           bb_word_t *east)
+{
+  const int dy = (r < 0) ? 0 : (r >= TILE_SIZE ? 2 : 1);
+  const int rr = (r < 0) ? TILE_SIZE - 1 : (r >= TILE_SIZE ? 0 : r);
+  ut_tile_t *w = t->nbr[dy][0], *c = t->nbr[dy][1], *e = t->nbr[dy][2];
+
+  *west = w ? ut_row (w, rr)[UT_WORDS - 1] : 0;
+  *east = e ? ut_row (e, rr)[0] : 0;
+
+  return c ? ut_row (c, rr) : ut_zero_row;
+}
+
+static inline bb_word_t ut_west (const bb_word_t *r, int w, bb_word_t west)
+{
+  return (r[w] << 1) | ((w > 0 ? r[w - 1] : west) >> (BB_BITS - 1));
+}
+
+static inline bb_word_t ut_east (const bb_word_t *r, int w, bb_word_t east)
+{
+  return (r[w] >> 1) | ((w < UT_WORDS - 1 ? r[w + 1] : east) << (BB_BITS - 1));
+}
+
+rule_inline bb_word_t ut_do_tile_rule (ut_tile_t *t, unsigned born,
+                                       unsigned survive)
+{
+  bb_word_t diff = 0;
+
+  for (int r = 0; r < TILE_SIZE; r++) {
+    bb_word_t uw, ue, mw, me, dw, de;
+    const bb_word_t *up   = ut_nbr_row (t, r - 1, &uw, &ue);
+    const bb_word_t *mid  = ut_nbr_row (t, r, &mw, &me);
+    const bb_word_t *down = ut_nbr_row (t, r + 1, &dw, &de);
+    bb_word_t *out        = t->next + r * UT_WORDS;
+
+    for (int w = 0; w < UT_WORDS; w++) {
+      const bb_word_t n = bb_life_word (
+          ut_west (up, w, uw), up[w], ut_east (up, w, ue), ut_west (mid, w, mw),
+          mid[w], ut_east (mid, w, me), ut_west (down, w, dw), down[w],
+          ut_east (down, w, de), born, survive);
+
+      diff |= n ^ mid[w];
+      out[w] = n;
+    }
+  }
+
+  return diff;
+}
+
+static bb_word_t ut_do_tile_reg (ut_tile_t *t)
+{
+  return rule_dispatch (ut_do_tile_rule, t);
+}
+
+// Tiles outside of the viewport do not show up in the monitoring
+static bb_word_t ut_do_tile (ut_tile_t *t, int who)
+{
+  const int64_t y = t->ty * TILE_SIZE, x = t->tx * TILE_SIZE;
+  const int visible = (y >= 0 && x >= 0 && y < DIM && x < DIM);
+  bb_word_t diff;
+
+  if (visible)
+    monitoring_start_tile (who);
+
+  diff = ut_do_tile_reg (t);
+
+  if (visible)
+    monitoring_end_tile (x, y, TILE_SIZE, TILE_SIZE, who);
+
+  return diff;
+}
+
+static unsigned ut_compute (unsigned nb_iter, int parallel)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    bb_word_t diff = 0;
+
+    ut_add_neighbours ();
+
+#pragma omp parallel for if (parallel) schedule(dynamic, 8) reduction(| : diff)
+    for (size_t i = 0; i < ut_nb_tiles; i++)
+      diff |= ut_do_tile (ut_list[i], omp_get_thread_num ());
+
+    for (size_t i = ut_nb_tiles; i-- > 0;) {
+      ut_tile_t *t   = ut_list[i];
+      bb_word_t *tmp = t->cur;
+      bb_word_t pop  = 0;
+
+      t->cur  = t->next;
+      t->next = tmp;
+
+      for (int k = 0; k < TILE_SIZE * UT_WORDS; k++)
+        pop |= t->cur[k];
+      if (!pop)
+        ut_free (i);
+    }
+
+    if (!diff)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned life_compute_unbounded (unsigned nb_iter)
+{
+  return ut_compute (nb_iter, 0);
+}
+
+unsigned life_compute_unbounded_omp (unsigned nb_iter)
+{
+  return ut_compute (nb_iter, 1);
+}
+
+///////////////////////////// Live-cell set version (sparse)
+// Suggested cmdline:
+// ./run -k life -v sparse -s 1024 -a diehard -i 1000
+//
+// The universe is the sorted set of the coordinates of its live cells, so
+// memory is proportional to the population and coordinates only have to fit
+// in 32 bits. At each generation, every live cell emits its eight neighbours.
+// A radix sort of the emitted keys gathers the contributions to a cell, and
+// the length of its run is its number of live neighbours. The DIM x DIM
+// window is a viewport on the universe.
+
+#define SP_PARALLEL_MIN 65536 // smaller sets are processed sequentially
+
+typedef uint64_t sp_key_t;
+
+// sp_cells, then two buffers for emitted keys, all with sp_capacity keys
+static sp_key_t *sp_buf[2] = {NULL, NULL};
+static size_t sp_size = 0, sp_capacity = 0;
+static int sp_sorted = 1;
+
+// Keys are ordered by row, then by column. With biased halves, the key of a
+// neighbour is obtained by adding a constant.
+static inline sp_key_t sp_key (int64_t y, int64_t x)
+{
+  return ((sp_key_t)((uint32_t)y ^ 0x80000000U) << 32) |
+         ((uint32_t)x ^ 0x80000000U);
+}
+
+static inline int64_t sp_key_y (sp_key_t k)
+{
+  return (int32_t)((uint32_t)(k >> 32) ^ 0x80000000U);
+}
+
+static inline int64_t sp_key_x (sp_key_t k)
+{
+  return (int32_t)((uint32_t)k ^ 0x80000000U);
+}
+
+#define SP_ROW ((int64_t)1 << 32)
+
+static const int64_t sp_delta[8] = {-SP_ROW - 1, -SP_ROW,    -SP_ROW + 1, -1,
+                                    1,           SP_ROW - 1, SP_ROW,      SP_ROW + 1};
+
+static void sp_reserve (size_t size)
+{
+  if (size <= sp_capacity)
+    return;
+
+  sp_capacity = max (size, 2 * sp_capacity);
+  sp_cells    = realloc (sp_cells, sp_capacity * sizeof (sp_key_t));
+  for (int b = 0; b < 2; b++)
+    sp_buf[b] = realloc (sp_buf[b], sp_capacity * sizeof (sp_key_t));
+
+  if (sp_cells == NULL || sp_buf[0] == NULL || sp_buf[1] == NULL)
+    exit_with_error ("Cannot allocate %zu live cells", sp_capacity);
+}
+
+static void sp_init (void)
+{
+  if (sp_cells == NULL)
+    sp_reserve (1024);
+}
+
+static void sp_finalize (void)
+{
+  free (sp_cells);
+  free (sp_buf[0]);
+  free (sp_buf[1]);
+  sp_cells  = sp_buf[0] = sp_buf[1] = NULL;
+  sp_size   = sp_capacity = 0;
+  sp_sorted = 1;
+}
+
+// LSD radix sort on bytes of the n keys of a, using tmp. Bytes shared by all
+// keys are skipped. Returns the sorted buffer, either a or tmp.
+static sp_key_t *sp_sort (sp_key_t *a, sp_key_t *tmp, size_t n)
+{
+  const int parallel = n >= SP_PARALLEL_MIN;
+  size_t(*count)[256] = malloc (omp_get_max_threads () * sizeof (*count));
+  sp_key_t diff       = 0;
+
+#pragma omp parallel for if (parallel) reduction(| : diff)
+  for (size_t i = 0; i < n; i++)
+    diff |= a[i] ^ a[0];
+
+  for (int shift = 0; shift < 64; shift += 8) {
+    if (!((diff >> shift) & 0xFF))
+      continue;
+
+    // Each thread counts then scatters its own slice: digit-major offsets
+    // keep the sort stable
+#pragma omp parallel if (parallel)
+    {
+      const int who = omp_get_thread_num (), nb = omp_get_num_threads ();
+      const size_t begin = n * who / nb, end = n * (who + 1) / nb;
+      size_t *c          = count[who];
+
+      memset (c, 0, sizeof (*count));
+      for (size_t i = begin; i < end; i++)
+        c[(a[i] >> shift) & 0xFF]++;
+
+#pragma omp barrier
+#pragma omp single
+      {
+        size_t sum = 0;
+
+        for (int d = 0; d < 256; d++)
+          for (int w = 0; w < nb; w++) {
+            const size_t v = count[w][d];
+
+            count[w][d] = sum;
+            sum += v;
+          }
+      }
+
+      for (size_t i = begin; i < end; i++)
+        tmp[c[(a[i] >> shift) & 0xFF]++] = a[i];
+    }
 
-char changed = 0;
+    sp_key_t *t = a;
+    a           = tmp;
+    tmp         = t;
+  }
 
-char change[2][10] = {{0,0,0,1,0,0,0,0,0,0},{1,1,1,0,0,1,1,1,1,1}};
-char rules[2][10] = {{0,0,0,1,0,0,0,0,0,0},{0,0,0,1,1,0,0,0,0,0}};
+  free (count);
 
-static cell_t *restrict _table = NULL, *restrict _alternate_table = NULL,*restrict change_table = NULL,*restrict _alternate_change_table = NULL;
+  return a;
+}
 
-static inline cell_t *table_cell (cell_t *restrict i, int y, int x)
+// Sorts the cells added by sp_set_cell and removes duplicates
+static void sp_normalize (void)
 {
-  return i + y * DIM + x;
+  size_t m = 0;
+
+  if (sp_sorted)
+    return;
+
+  const sp_key_t *s = sp_sort (sp_cells, sp_buf[0], sp_size);
+
+  for (size_t i = 0; i < sp_size; i++)
+    if (m == 0 || s[i] != sp_buf[1][m - 1])
+      sp_buf[1][m++] = s[i];
+
+  sp_key_t *t = sp_cells;
+  sp_cells    = sp_buf[1];
+  sp_buf[1]   = t;
+  sp_size     = m;
+  sp_sorted   = 1;
 }
 
-// This kernel does not directly work on cur_img/next_img.
-// Instead, we use 2D arrays of boolean values, not colors
-#define cur_table(y, x) (*table_cell (_table, (y), (x)))
-#define next_table(y, x) (*table_cell (_alternate_table, (y), (x)))
+static void sp_set_cell (int64_t y, int64_t x)
+{
+  sp_reserve (sp_size + 1);
+  sp_cells[sp_size++] = sp_key (y, x);
+  sp_sorted           = 0;
+}
 
-void life_init (void)
+static int sp_get_cell (int64_t y, int64_t x)
 {
+  const sp_key_t k = sp_key (y, x);
+  size_t lo = 0, hi;
 
-  // life_init may be (indirectly) called several times so we check if data were
-  // already allocated
-  if (_table == NULL) {
-    const unsigned size = DIM * DIM * sizeof (cell_t);
-
-    PRINT_DEBUG ('u', "Memory footprint = 2 x %d bytes\n", size);
-
-    _table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-
-    _alternate_table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-
-    change_table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    _alternate_change_table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-     toSee = malloc(sizeof(int)*NB_TILE*NB_TILE);
-     for (int i = 0; i < NB_TILE; i++)
-       for (int j = 0; j < NB_TILE; j++) {
-         toSee[(i*NB_TILE) + j] = 0;
-     }
-     isUpdate = malloc(sizeof(int)*NB_TILE*NB_TILE);
-      for (int i = 0; i < NB_TILE; i++)
-        for (int j = 0; j < NB_TILE; j++) {
-          isUpdate[(i*NB_TILE) + j] = 0;
-      }
-     nb_iteration =  0;
- }
+  sp_normalize ();
+
+  for (hi = sp_size; lo < hi;) {
+    const size_t mid = (lo + hi) / 2;
+
+    if (sp_cells[mid] < k)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo < sp_size && sp_cells[lo] == k;
+}
+
+static void sp_refresh_img (void)
+{
+  memset (image, 0, (size_t)DIM * DIM * sizeof (uint32_t));
+
+  sp_normalize ();
+
+  for (size_t i = 0; i < sp_size; i++) {
+    const int64_t y = sp_key_y (sp_cells[i]), x = sp_key_x (sp_cells[i]);
+
+    if (y >= 0 && y < DIM && x >= 0 && x < DIM)
+      cur_img (y, x) = color;
+  }
 }
 
-void printAled(){
-  printf("\n\n");
-  for (int i = 0; i < NB_TILE; i++){
-    for (int j = 0; j < NB_TILE; j++) {
-      printf("%d ", toSee[(i*NB_TILE) + j]);
+unsigned life_compute_sparse (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    sp_normalize ();
+
+    const size_t n = 8 * sp_size;
+    size_t m       = 0;
+
+    // The next generation has at most one cell per emitted key, plus the
+    // isolated live cells if the rule has S0
+    sp_reserve (n + sp_size);
+
+    monitoring_start_tile (0);
+
+#pragma omp parallel for if (n >= SP_PARALLEL_MIN) schedule(static)
+    for (size_t i = 0; i < sp_size; i++)
+      for (int k = 0; k < 8; k++)
+        sp_buf[0][8 * i + k] = sp_cells[i] + sp_delta[k];
+
+    const sp_key_t *s = sp_sort (sp_buf[0], sp_buf[1], n);
+    sp_key_t *out     = (s == sp_buf[0]) ? sp_buf[1] : sp_buf[0];
+
+    // Runs of equal keys are merged with the set of live cells, both being
+    // sorted
+    size_t j = 0;
+
+    for (size_t i = 0; i < n;) {
+      const sp_key_t k = s[i];
+      size_t e         = i + 1;
+
+      while (e < n && s[e] == k)
+        e++;
+
+      for (; j < sp_size && sp_cells[j] < k; j++)
+        if (rule_survive & 1)
+          out[m++] = sp_cells[j];
+
+      const int alive = j < sp_size && sp_cells[j] == k;
+
+      j += alive;
+      if (((alive ? rule_survive : rule_born) >> (e - i)) & 1)
+        out[m++] = k;
+
+      i = e;
     }
-    printf("\n");
+
+    for (; j < sp_size; j++)
+      if (rule_survive & 1)
+        out[m++] = sp_cells[j];
+
+    monitoring_end_tile (0, 0, DIM, DIM, 0);
+
+    const int stable =
+        m == sp_size && !memcmp (out, sp_cells, m * sizeof (sp_key_t));
+
+    sp_buf[out == sp_buf[1]] = sp_cells;
+    sp_cells                 = out;
+    sp_size  = m;
+
+    if (stable)
+      return it;
   }
+
+  return 0;
 }
 
-void life_finalize (void)
+///////////////////////////// HashLife version (hashlife)
+// Suggested cmdline:
+// LIFE_HASHLIFE_MEM=2048 ./run -k life -v hashlife -s 6208 -a meta3x3 -n -i 35328
+//
+// The universe is a quadtree whose nodes are hash-consed, so identical
+// squares are shared. A node of level L (2^L x 2^L cells) memoizes its
+// RESULT: its central 2^(L-1) square, 2^(L-2) generations later. Smaller
+// steps of 2^j generations (j < L-2) are memoized in a separate (node, j)
+// cache. nb_iter is split into powers of two, so a call advances nb_iter
+// generations with O(log nb_iter) steps.
+//
+// Unlike the dense variants, the universe is not clipped to the DIM x DIM
+// window: cells crossing the border keep evolving outside of it. Cells are
+// rasterized only when the image is refreshed.
+//
+// Draw functions fill the bitboard; the quadtree is built from it on the
+// first call to life_compute_hashlife.
+//
+// LIFE_HASHLIFE_MEM (in MiB) caps the memory used by nodes and caches. It is
+// checked each time hl_step starts a new square: when exceeded, the nodes
+// which are neither reachable from the root nor from a square being computed
+// (kept on hl_stack) are reclaimed. Memoized results of the nodes kept are
+// dropped too if they still fill more than half of the cap. If the live
+// nodes alone do, the next collection is postponed until they have doubled,
+// so that collections do not follow each other.
+//
+// As with the other variants, the computation stops at the first generation
+// which does not change the universe. Still universes stay still, so a step
+// is only kept if the universe it leads to is not still yet (a single
+// generation leaves it unchanged): the kept steps reach the last generation
+// before the universe stops changing.
+
+#define HL_DEFAULT_MEM 512 // MiB
+#define HL_POOL_SIZE 65536 // nodes allocated at once
+#define HL_MAX_LEVEL 64
+#define HL_FRAME_SIZE 14 // nodes kept on hl_stack by one hl_step call
+
+typedef struct hl_cache_entry
 {
-  const unsigned size = DIM * DIM * sizeof (cell_t);
+  hl_node_t *node, *result;
+  struct hl_cache_entry *next;
+  unsigned step;
+} hl_cache_entry_t;
 
-  munmap (_table, size);
-  munmap (_alternate_table, size);
+static hl_node_t hl_leaves[2]; // dead and alive cells (level 0)
+static hl_node_t *hl_empty[HL_MAX_LEVEL];
+static hl_node_t *hl_free_nodes = NULL;
+static hl_node_t **hl_buckets   = NULL;
+static size_t hl_nb_buckets = 0, hl_nb_nodes = 0;
+
+static hl_cache_entry_t *hl_free_entries = NULL;
+static hl_cache_entry_t **hl_cache       = NULL;
+static size_t hl_cache_size = 0, hl_nb_entries = 0;
+
+static void **hl_pools = NULL;
+static size_t hl_nb_pools = 0;
+
+static size_t hl_mem_cap, hl_gc_trigger;
+
+// Nodes being computed, which must survive a collection
+static hl_node_t *hl_stack[HL_MAX_LEVEL * HL_FRAME_SIZE + 2];
+static size_t hl_stack_top = 0;
+
+// Position of the root top-left corner in the DIM x DIM window
+static int64_t hl_y0, hl_x0;
+
+static inline size_t hl_hash (hl_node_t *nw, hl_node_t *ne, hl_node_t *sw,
+                              hl_node_t *se)
+{
+  uint64_t h = (uintptr_t)nw;
+
+  h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)ne;
+  h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)sw;
+  h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)se;
+
+  return (h ^ (h >> 29)) & (hl_nb_buckets - 1);
 }
 
-// This function is called whenever the graphical window needs to be refreshed
-void life_refresh_img (void)
+static void *hl_pool_alloc (size_t elem_size)
 {
-  for (int i = 0; i < DIM; i++)
-    for (int j = 0; j < DIM; j++)
-      cur_img (i, j) = cur_table (i, j) * color;
+  void *pool = malloc (HL_POOL_SIZE * elem_size);
+
+  if (pool == NULL)
+    exit_with_error ("Cannot allocate HashLife pool");
+
+  hl_pools                = realloc (hl_pools, (hl_nb_pools + 1) * sizeof (void *));
+  hl_pools[hl_nb_pools++] = pool;
+
+  return pool;
 }
 
-static inline void swap_tables (void)
+static size_t hl_memory_used (void)
 {
-  cell_t *tmp = _table;
+  return hl_nb_nodes * sizeof (hl_node_t) +
+         hl_nb_entries * sizeof (hl_cache_entry_t) +
+         hl_nb_buckets * sizeof (hl_node_t *) +
+         hl_cache_size * sizeof (hl_cache_entry_t *);
+}
 
-  _table           = _alternate_table;
-  _alternate_table = tmp;
+static inline void hl_push (hl_node_t *n)
+{
+  if (hl_stack_top == sizeof (hl_stack) / sizeof (hl_stack[0]))
+    exit_with_error ("HashLife stack overflow");
+
+  hl_stack[hl_stack_top++] = n;
 }
 
-///////////////////////////// Sequential version (seq)
+static void hl_collect (void);
+
+static void hl_rehash (void)
+{
+  const size_t old_size = hl_nb_buckets;
+  hl_node_t **old       = hl_buckets;
+
+  hl_nb_buckets = old_size ? 2 * old_size : 1 << 16;
+  hl_buckets    = calloc (hl_nb_buckets, sizeof (hl_node_t *));
+  if (hl_buckets == NULL)
+    exit_with_error ("Cannot allocate HashLife hash table");
+
+  for (size_t b = 0; b < old_size; b++)
+    for (hl_node_t *n = old[b], *next; n != NULL; n = next) {
+      const size_t h = hl_hash (n->nw, n->ne, n->sw, n->se);
+
+      next          = n->next;
+      n->next       = hl_buckets[h];
+      hl_buckets[h] = n;
+    }
 
-void updateNextIter(int x, int y){
-  isUpdate[(x/TILE_SIZE)*NB_TILE + y/TILE_SIZE] = nb_iteration;
+  free (old);
 }
 
-static int compute_new_state (int y, int x)
+// Returns the canonical node made of these four quadrants
+static hl_node_t *hl_join (hl_node_t *nw, hl_node_t *ne, hl_node_t *sw,
+                           hl_node_t *se)
 {
-  unsigned n  = 0;
-  unsigned me = cur_table (y, x) != 0;
-  unsigned change = 0;
+  const size_t h = hl_hash (nw, ne, sw, se);
+  hl_node_t *n;
 
-  if (x > 0 && x < DIM - 1 && y > 0 && y < DIM - 1) {
+  for (n = hl_buckets[h]; n != NULL; n = n->next)
+    if (n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+      return n;
 
-    for (int i = y - 1; i <= y + 1; i++)
-      for (int j = x - 1; j <= x + 1; j++)
-        n += cur_table (i, j);
+  if (hl_free_nodes == NULL) {
+    hl_node_t *pool = hl_pool_alloc (sizeof (hl_node_t));
 
-    n = (n == 3 + me) | (n == 3);
-    if (n != me){
-      changed = 1;
-      updateNextIter(y, x);
+    for (int i = 0; i < HL_POOL_SIZE; i++) {
+      pool[i].next  = hl_free_nodes;
+      hl_free_nodes = pool + i;
+    }
   }
 
-    next_table (y, x) = n;
-  }
+  n             = hl_free_nodes;
+  hl_free_nodes = n->next;
+
+  n->nw     = nw;
+  n->ne     = ne;
+  n->sw     = sw;
+  n->se     = se;
+  n->result = NULL;
+  n->level  = nw->level + 1;
+  n->mark   = 0;
 
-  return change;
+  n->next       = hl_buckets[h];
+  hl_buckets[h] = n;
+
+  if (++hl_nb_nodes > hl_nb_buckets)
+    hl_rehash ();
+
+  return n;
 }
 
-static void compute_new_state_omp (int y, int x)
+static hl_node_t *hl_empty_node (unsigned level)
 {
-    __m256i m = _mm256_setzero_si256();
-    int n;
-    for (int i = y - 1; i <= y + 1; i++)
-      for (int j = x - 1; j <= x + 1; j++){
-          m=_mm256_add_epi8(m,_mm256_set1_epi8(cur_table (i, j)));
-      }
-    n = _mm256_extract_epi8(m,0);
-    if(change[cur_table (y,x)!=0][n]){
-        changed = 1;
-        updateNextIter(y, x);
-    }
+  if (hl_empty[level] == NULL)
+    hl_empty[level] = level == 0 ? &hl_leaves[0]
+                                 : hl_join (hl_empty_node (level - 1),
+                                            hl_empty_node (level - 1),
+                                            hl_empty_node (level - 1),
+                                            hl_empty_node (level - 1));
+  return hl_empty[level];
+}
 
-    next_table (y, x) = rules[cur_table (y,x)!=0][n];
+static inline int hl_is_empty (hl_node_t *n)
+{
+  return n == hl_empty_node (n->level);
 }
 
+// Same square, surrounded by an empty ring: level + 1
+static hl_node_t *hl_expand (hl_node_t *n)
+{
+  hl_node_t *e = hl_empty_node (n->level - 1);
 
-unsigned life_compute_seq (unsigned nb_iter)
+  return hl_join (hl_join (e, e, e, n->nw), hl_join (e, e, n->ne, e),
+                  hl_join (e, n->sw, e, e), hl_join (n->se, e, e, e));
+}
+
+// Central square at time 0: level - 1
+static inline hl_node_t *hl_center (hl_node_t *n)
 {
-  for (unsigned it = 1; it <= nb_iter; it++) {
-    int change = 0;
+  return hl_join (n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
 
-    monitoring_start_tile (0);
+static inline size_t hl_cache_hash (hl_node_t *n, unsigned step)
+{
+  const uint64_t h = ((uintptr_t)n + step) * 0x9E3779B97F4A7C15ULL;
 
-    for (int i = 0; i < DIM; i++)
-      for (int j = 0; j < DIM; j++)
-        change |= compute_new_state (i, j);
+  return (h ^ (h >> 29)) & (hl_cache_size - 1);
+}
 
-    monitoring_end_tile (0, 0, DIM, DIM, 0);
+static void hl_cache_rehash (void)
+{
+  const size_t old_size  = hl_cache_size;
+  hl_cache_entry_t **old = hl_cache;
 
-    swap_tables ();
+  hl_cache_size = old_size ? 2 * old_size : 1 << 16;
+  hl_cache      = calloc (hl_cache_size, sizeof (hl_cache_entry_t *));
+  if (hl_cache == NULL)
+    exit_with_error ("Cannot allocate HashLife result cache");
 
-    if (!change)
-      return it;
-  }
+  for (size_t b = 0; b < old_size; b++)
+    for (hl_cache_entry_t *e = old[b], *next; e != NULL; e = next) {
+      const size_t h = hl_cache_hash (e->node, e->step);
 
-  return 0;
+      next        = e->next;
+      e->next     = hl_cache[h];
+      hl_cache[h] = e;
+    }
+
+  free (old);
 }
 
-void life_refresh_img_ocl ()
+static hl_node_t *hl_cache_lookup (hl_node_t *n, unsigned step)
 {
-    printf("Coucou c'est moi \n");
-  cl_int err;
+  const size_t h = hl_cache_hash (n, step);
 
-  err =
-      clEnqueueReadBuffer (queue, cur_buffer, CL_TRUE, 0,
-                           sizeof (cell_t) * DIM * DIM, _table, 0, NULL, NULL);
-  check (err, "Failed to read buffer from GPU");
+  for (hl_cache_entry_t *e = hl_cache[h]; e != NULL; e = e->next)
+    if (e->node == n && e->step == step)
+      return e->result;
 
-  life_refresh_img ();
+  return NULL;
 }
 
-
-void life_init_ocl (void)
+static void hl_cache_insert (hl_node_t *n, unsigned step, hl_node_t *result)
 {
+  const size_t h = hl_cache_hash (n, step);
+  hl_cache_entry_t *e;
+
+  if (hl_free_entries == NULL) {
+    hl_cache_entry_t *pool = hl_pool_alloc (sizeof (hl_cache_entry_t));
+
+    for (int i = 0; i < HL_POOL_SIZE; i++) {
+      pool[i].next    = hl_free_entries;
+      hl_free_entries = pool + i;
+    }
+  }
 
-  change_buffer = clCreateBuffer (context, CL_MEM_READ_WRITE,
-                              sizeof (unsigned) * DIM * DIM, NULL, NULL);
-  if (!change_buffer)
-    exit_with_error ("Failed to allocate input buffer");
+  e               = hl_free_entries;
+  hl_free_entries = e->next;
 
-  next_change = clCreateBuffer (context, CL_MEM_READ_WRITE,
-                                sizeof (unsigned) * DIM * DIM, NULL, NULL);
-  if (!next_change)
-  exit_with_error ("Failed to allocate output buffer");
+  e->node   = n;
+  e->step   = step;
+  e->result = result;
+  e->next   = hl_cache[h];
+  hl_cache[h] = e;
+
+  if (++hl_nb_entries > hl_cache_size)
+    hl_cache_rehash ();
 }
 
-void life_draw_ocl (char *param)
+// One generation of the central 2x2 square of a 4x4 (level 2) node
+rule_inline hl_node_t *hl_base_case_rule (hl_node_t *n, unsigned born,
+                                          unsigned survive)
 {
-  const int size       = DIM * DIM * sizeof (unsigned);
-  cl_int err;
-
-  unsigned *change_table = malloc (size);
-  unsigned *_alternate_change_table = malloc (size);
+  hl_node_t *q[4] = {n->nw, n->ne, n->sw, n->se};
+  int cell[4][4], next[2][2];
 
-  for (int i = 1; i < NB_TILE+1; i++)
-    for (int j = 1; j < NB_TILE+1; j++) {
-      change_table[(i*DIM) + j] = 1;
-  }
-  for(int j = 0; j < DIM; j++){
-      change_table[j] = 0;
-  }
-  for(int j = 0; j < DIM; j++){
-      change_table[j+DIM*(NB_TILE+1)] = 0;
+  for (int k = 0; k < 4; k++) {
+    cell[(k / 2) * 2][(k % 2) * 2]         = q[k]->nw == &hl_leaves[1];
+    cell[(k / 2) * 2][(k % 2) * 2 + 1]     = q[k]->ne == &hl_leaves[1];
+    cell[(k / 2) * 2 + 1][(k % 2) * 2]     = q[k]->sw == &hl_leaves[1];
+    cell[(k / 2) * 2 + 1][(k % 2) * 2 + 1] = q[k]->se == &hl_leaves[1];
   }
-  for(int i = 0; i < DIM; i++){
-      change_table[i*DIM] = 0;
-  }
-  for(int i = 0; i < DIM; i++){
-      change_table[i*DIM+NB_TILE+1] = 0;
-  }
-  for (int i = 0; i < DIM*DIM; i++)
-      _alternate_change_table[i] = 0;
 
+  for (int y = 1; y <= 2; y++)
+    for (int x = 1; x <= 2; x++) {
+      int count = 0;
 
-  err = clEnqueueWriteBuffer (queue, change_buffer, CL_TRUE, 0,
-                              size, change_table, 0, NULL,NULL);
-  check (err, "Failed to write to extra buffer");
+      for (int i = y - 1; i <= y + 1; i++)
+        for (int j = x - 1; j <= x + 1; j++)
+          count += cell[i][j];
 
-  err = clEnqueueWriteBuffer (queue, next_change, CL_TRUE, 0, size, _alternate_change_table, 0,
-                              NULL, NULL);
-  check (err, "Failed to write to extra buffer");
+      next[y - 1][x - 1] = rule_next (cell[y][x], count, born, survive);
+    }
 
-  free (change_table);
-  free(_alternate_change_table);
+  return hl_join (&hl_leaves[next[0][0]], &hl_leaves[next[0][1]],
+                  &hl_leaves[next[1][0]], &hl_leaves[next[1][1]]);
+}
 
-  img_data_replicate ();
-  life_refresh_img_ocl();
+static hl_node_t *hl_base_case (hl_node_t *n)
+{
+  return rule_dispatch (hl_base_case_rule, n);
 }
 
+// Central square of n (level - 1), 2^step generations later. Requires
+// step <= level - 2. The intermediate squares live on hl_stack, so that a
+// collection triggered by a nested call keeps them.
+static hl_node_t *hl_step (hl_node_t *n, unsigned step)
+{
+  const int full = (step == n->level - 2);
+  hl_node_t *r;
 
+  if (full && n->result != NULL)
+    return n->result;
 
+  if (hl_is_empty (n))
+    return hl_empty_node (n->level - 1);
 
+  if (n->level == 2)
+    return n->result = hl_base_case (n);
 
+  if (!full && (r = hl_cache_lookup (n, step)) != NULL)
+    return r;
 
+  const size_t frame = hl_stack_top;
 
-//
-// void life_alloc_buffers_ocl (void)
-// {
-//   // Allocate buffers inside device memory
-//   //
-//   cur_buffer = clCreateBuffer (context, CL_MEM_READ_WRITE,
-//                                sizeof (unsigned) * DIM * DIM, NULL, NULL);
-//   if (!cur_buffer)
-//     exit_with_error ("Failed to allocate input buffer");
-//
-//   next_buffer = clCreateBuffer (context, CL_MEM_READ_WRITE,
-//                                 sizeof (unsigned) * DIM * DIM, NULL, NULL);
-//   if (!next_buffer)
-//     exit_with_error ("Failed to allocate output buffer");
-//   // Allocate buffers inside device memory
-//   //
-//
-//
-//   printf("Je commence ma première écriture dans le buffer\n");
-//   cl_int err = clEnqueueWriteBuffer (queue, change_buffer, CL_TRUE, 0,
-//                               sizeof (unsigned) * DIM * DIM, change_table, 0, NULL,
-//                               NULL);
-//   check (err, "Failed to write to change_buffer");
-//   printf("Je termine ma première écriture dans le buffer\n");
-//   printf("Je commence ma deuxième écriture dans le buffer\n");
-//   err = clEnqueueWriteBuffer (queue, next_change, CL_TRUE, 0,
-//                               sizeof (unsigned) * DIM * DIM, _alternate_change_table, 0, NULL,
-//                               NULL);
-//   check (err, "Failed to write to next_change");
-//   printf("Je termine ma deuxième écriture dans le buffer\n");
-// }
+  hl_push (n);
 
-unsigned life_invoke_ocl (unsigned nb_iter)
+  if (hl_memory_used () > hl_gc_trigger)
+    hl_collect ();
+
+  // The nine overlapping squares of level - 1, then the four squares of the
+  // second stage
+  hl_node_t **c = hl_stack + hl_stack_top, **q = c + 9;
+
+  hl_push (n->nw);
+  hl_push (hl_join (n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw));
+  hl_push (n->ne);
+  hl_push (hl_join (n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne));
+  hl_push (hl_center (n));
+  hl_push (hl_join (n->ne->sw, n->ne->se, n->se->nw, n->se->ne));
+  hl_push (n->sw);
+  hl_push (hl_join (n->sw->ne, n->se->nw, n->sw->se, n->se->sw));
+  hl_push (n->se);
+
+  // A full step advances twice by 2^(level-3), a smaller one advances only
+  // in the second stage
+  for (int k = 0; k < 9; k++)
+    c[k] = full ? hl_step (c[k], step - 1) : hl_center (c[k]);
+
+  const unsigned sub_step = full ? step - 1 : step;
+
+  hl_push (hl_step (hl_join (c[0], c[1], c[3], c[4]), sub_step));
+  hl_push (hl_step (hl_join (c[1], c[2], c[4], c[5]), sub_step));
+  hl_push (hl_step (hl_join (c[3], c[4], c[6], c[7]), sub_step));
+  hl_push (hl_step (hl_join (c[4], c[5], c[7], c[8]), sub_step));
+
+  r = hl_join (q[0], q[1], q[2], q[3]);
+
+  if (full)
+    n->result = r;
+  else
+    hl_cache_insert (n, step, r);
+
+  hl_stack_top = frame;
+
+  return r;
+}
+
+// Cells outside of the central half of the node are all dead
+static inline int hl_inner_half_only (hl_node_t *n)
 {
-    size_t global[2] = {SIZE, SIZE};   // global domain size for our calculation
-    size_t local[2]  = {TILEX, TILEY}; // local domain size for our calculation
-    static cl_event prof_event;
-    life_init();
-
-    for (unsigned it = 1; it <= nb_iter; it++) {
-      // Set kernel arguments
-      //
-      cl_int err = 0;
-      err |= clSetKernelArg (compute_kernel, 0, sizeof (cl_mem), &cur_buffer);
-      err |= clSetKernelArg (compute_kernel, 1, sizeof (cl_mem), &next_buffer);
-      err |= clSetKernelArg (compute_kernel, 2, sizeof (cl_mem), &change_buffer);
-      err |= clSetKernelArg (compute_kernel, 3, sizeof (cl_mem), &next_change);
-      check (err, "Failed to set kernel arguments");
-      err = clEnqueueNDRangeKernel (queue, compute_kernel, 2, NULL, global, local,
-                                    0, NULL, &prof_event);
-      check (err, "Failed to execute kernel");
+  const unsigned l = n->level - 2;
 
-      // Swap buffers
-      {
-        cl_mem tmp  = cur_buffer;
-        cur_buffer  = next_buffer;
-        next_buffer = tmp;
-      }
-      {
-        cl_mem tmp1  = change_buffer;
-        change_buffer  = next_change;
-        next_change = tmp1;
-      }
-    }
-    return 0;
+  return n->nw->nw == hl_empty_node (l) && n->nw->ne == hl_empty_node (l) &&
+         n->nw->sw == hl_empty_node (l) && n->ne->nw == hl_empty_node (l) &&
+         n->ne->ne == hl_empty_node (l) && n->ne->se == hl_empty_node (l) &&
+         n->sw->nw == hl_empty_node (l) && n->sw->sw == hl_empty_node (l) &&
+         n->sw->se == hl_empty_node (l) && n->se->ne == hl_empty_node (l) &&
+         n->se->sw == hl_empty_node (l) && n->se->se == hl_empty_node (l);
 }
 
-///////////////////////////// Tiled sequential version (tiled)
+static void hl_grow_root (void)
+{
+  hl_y0 -= (int64_t)1 << (hl_root->level - 1);
+  hl_x0 -= (int64_t)1 << (hl_root->level - 1);
+  hl_root = hl_expand (hl_root);
+}
 
-unsigned life_compute_omp (unsigned nb_iter)
+// Marks the nodes reachable from n, and from their results if keep is set
+static void hl_mark (hl_node_t *n, int keep)
 {
-  for (unsigned it = 1; it <= nb_iter; it++) {
+  if (n == NULL || n->mark || n->level == 0)
+    return;
 
-    monitoring_start_tile (0);
+  n->mark = 1;
+  hl_mark (n->nw, keep);
+  hl_mark (n->ne, keep);
+  hl_mark (n->sw, keep);
+  hl_mark (n->se, keep);
+  if (keep)
+    hl_mark (n->result, keep);
+}
+
+// Flushes the (node, step) cache, then frees the nodes unreachable from the
+// root and from hl_stack. The results of the nodes kept are kept as well,
+// unless keep is zero.
+static void hl_sweep (int keep)
+{
+  for (size_t b = 0; b < hl_cache_size; b++)
+    for (hl_cache_entry_t *e = hl_cache[b], *next; e != NULL; e = next) {
+      next            = e->next;
+      e->next         = hl_free_entries;
+      hl_free_entries = e;
+    }
+  memset (hl_cache, 0, hl_cache_size * sizeof (hl_cache_entry_t *));
+  hl_nb_entries = 0;
 
-    #pragma omp parallel
-    #pragma omp for collapse(2) schedule(dynamic,8)
-    for (int i = 1; i < DIM-1; i++)
-      for (int j = 1; j < DIM-1; j++) {
-        compute_new_state_omp (i, j);
+  hl_mark (hl_root, keep);
+  for (size_t k = 0; k < hl_stack_top; k++)
+    hl_mark (hl_stack[k], keep);
+  for (int l = 1; l < HL_MAX_LEVEL; l++)
+    hl_mark (hl_empty[l], keep);
+
+  for (size_t b = 0; b < hl_nb_buckets; b++) {
+    hl_node_t **prev = &hl_buckets[b];
+
+    for (hl_node_t *n = *prev, *next; n != NULL; n = next) {
+      next = n->next;
+      if (n->mark) {
+        n->mark = 0;
+        if (!keep)
+          n->result = NULL;
+        prev = &n->next;
+      } else {
+        *prev         = next;
+        n->next       = hl_free_nodes;
+        hl_free_nodes = n;
+        hl_nb_nodes--;
       }
+    }
+  }
+}
 
+// Memoized results are dropped only if keeping them leaves more than half of
+// the cap in use
+static void hl_collect (void)
+{
+  const size_t before = hl_nb_nodes;
 
-    monitoring_end_tile (0, 0, DIM, DIM, 0);
+  hl_sweep (1);
+  if (hl_memory_used () > hl_mem_cap / 2)
+    hl_sweep (0);
 
-    swap_tables ();
+  const size_t used = hl_memory_used ();
 
-    if (!changed)
-      return it;
-     changed = 0;
+  hl_gc_trigger = used > hl_mem_cap / 2 ? 2 * used : hl_mem_cap;
+
+  PRINT_DEBUG ('u', "HashLife GC: %zu -> %zu nodes (%zu MiB live)\n", before,
+               hl_nb_nodes, used >> 20);
+}
+
+// Quadtree of the 2^level square at (y, x) of the bitboard
+static hl_node_t *hl_build (unsigned level, int y, int x)
+{
+  if (y >= DIM || x >= DIM)
+    return hl_empty_node (level);
+
+  if (level == 0)
+    return &hl_leaves[(cur_bb (y, x / BB_BITS) >> (x % BB_BITS)) & 1];
+
+  if (level <= 6) { // the square fits inside one word per row
+    const int size       = 1 << level;
+    const bb_word_t mask = (size == BB_BITS ? ~(bb_word_t)0
+                                            : (((bb_word_t)1 << size) - 1))
+                           << (x % BB_BITS);
+    bb_word_t bits = 0;
+
+    for (int i = y; i < min (y + size, (int)DIM); i++)
+      bits |= cur_bb (i, x / BB_BITS) & mask;
+    if (!bits)
+      return hl_empty_node (level);
   }
 
-  return 0;
+  const int half = 1 << (level - 1);
+
+  return hl_join (hl_build (level - 1, y, x), hl_build (level - 1, y, x + half),
+                  hl_build (level - 1, y + half, x),
+                  hl_build (level - 1, y + half, x + half));
 }
 
-// Tile inner computation
-static void do_tile_reg (int x, int y, int width, int height)
+static void hl_init (void)
 {
+  char *str         = getenv ("LIFE_HASHLIFE_MEM");
+  unsigned long mib = HL_DEFAULT_MEM;
 
-  for (int i = y; i < y + height; i++)
-    for (int j = x; j < x + width; j++)
-      compute_new_state_omp (i, j);
+  if (str != NULL) {
+    char *end;
+
+    mib = strtoul (str, &end, 10);
+    if (*str < '0' || *str > '9' || *end != '\0' || mib == 0 ||
+        mib > (SIZE_MAX >> 20))
+      exit_with_error ("LIFE_HASHLIFE_MEM (%s) should be a positive number "
+                       "of MiB",
+                       str);
+  }
+
+  hl_mem_cap = hl_gc_trigger = (size_t)mib << 20;
+  PRINT_DEBUG ('u', "HashLife memory cap = %zu MiB\n", hl_mem_cap >> 20);
 
+  hl_rehash ();
+  hl_cache_rehash ();
 }
 
-static void do_tile (int x, int y, int width, int height, int who)
+static void hl_finalize (void)
 {
+  for (size_t p = 0; p < hl_nb_pools; p++)
+    free (hl_pools[p]);
+  free (hl_pools);
+  free (hl_buckets);
+  free (hl_cache);
 
-  monitoring_start_tile (who);
+  hl_pools      = NULL;
+  hl_buckets    = NULL;
+  hl_cache      = NULL;
+  hl_root         = NULL;
+  hl_free_nodes   = NULL;
+  hl_free_entries = NULL;
+  hl_stack_top    = 0;
+  hl_nb_pools = hl_nb_buckets = hl_nb_nodes = 0;
+  hl_cache_size = hl_nb_entries = 0;
+  memset (hl_empty, 0, sizeof (hl_empty));
+}
 
-  do_tile_reg (x, y, width, height);
+static void hl_rasterize (hl_node_t *n, int64_t y, int64_t x)
+{
+  const int64_t size = (int64_t)1 << n->level;
 
-  monitoring_end_tile (x, y, width, height, who);
+  if (hl_is_empty (n) || y >= DIM || x >= DIM || y + size <= 0 ||
+      x + size <= 0)
+    return;
+
+  if (n->level == 0) {
+    cur_img (y, x) = color;
+    return;
+  }
 
+  hl_rasterize (n->nw, y, x);
+  hl_rasterize (n->ne, y, x + size / 2);
+  hl_rasterize (n->sw, y + size / 2, x);
+  hl_rasterize (n->se, y + size / 2, x + size / 2);
 }
 
-unsigned life_compute_tiled (unsigned nb_iter)
+static void hl_refresh_img (void)
 {
-  unsigned res = 0;
+  memset (image, 0, (size_t)DIM * DIM * sizeof (uint32_t));
+  hl_rasterize (hl_root, hl_y0, hl_x0);
+}
 
-  for (unsigned it = 1; it <= nb_iter; it++) {
+static int hl_get_cell (int y, int x)
+{
+  hl_node_t *n = hl_root;
+  int64_t dy = y - hl_y0, dx = x - hl_x0;
 
-    for (int y = 1; y < DIM-TILE_SIZE; y += TILE_SIZE)
-      for (int x = 1; x < DIM-TILE_SIZE; x += TILE_SIZE)
-        do_tile (x, y, TILE_SIZE, TILE_SIZE, 0);
+  if (dy < 0 || dx < 0 || dy >= ((int64_t)1 << n->level) ||
+      dx >= ((int64_t)1 << n->level))
+    return 0;
 
-    swap_tables ();
+  while (n->level > 0) {
+    const int64_t half = (int64_t)1 << (n->level - 1);
 
-    if (!changed) { // we stop when all cells are stable
-      res = it;
-      break;
-    }
+    if (dy < half)
+      n = dx < half ? n->nw : n->ne;
+    else
+      n = dx < half ? n->sw : n->se;
+    if (dy >= half)
+      dy -= half;
+    if (dx >= half)
+      dx -= half;
   }
-  changed = 0;
-  return res;
+
+  return n == &hl_leaves[1];
 }
 
-static inline int toCoord(int x, int y){
-  return (x * NB_TILE) + y;
+// Advances the universe by 2^j generations
+static void hl_advance (unsigned j)
+{
+  // Pattern must fit in the central quarter, so that nothing escapes from
+  // the central half returned by hl_step
+  while (hl_root->level < j + 3 || !hl_inner_half_only (hl_root))
+    hl_grow_root ();
+  hl_grow_root ();
+
+  hl_root = hl_step (hl_root, j);
+  hl_y0 += (int64_t)1 << (hl_root->level - 1);
+  hl_x0 += (int64_t)1 << (hl_root->level - 1);
 }
 
-unsigned life_compute_omp_tiled (unsigned nb_iter)
+// Returns 1 if the next generation is the same as the current one: nodes are
+// hash-consed, so equal squares are the same node
+static int hl_is_still (void)
 {
-  unsigned res = 0;
+  hl_node_t *n = hl_root;
 
-  int indice;
-  for (unsigned it = 1; it <= nb_iter; it++) {
-    int tmp_nb = nb_iteration;
-    nb_iteration += 1;
-    #pragma omp parallel
-    #pragma omp for collapse(2) schedule(dynamic,8)
-    for (int x = 1; x < NB_TILE-1; x += 1){
-      for (int y = 1; y < NB_TILE-1; y += 1){
-        if((toSee[toCoord(x - 1, y - 1)] == tmp_nb) || (toSee[toCoord(x, y - 1)] == tmp_nb)  || (toSee[toCoord(x + 1, y - 1)] == tmp_nb) || (toSee[toCoord(x - 1, y)]  == tmp_nb)
-          || (toSee[toCoord(x, y)] == tmp_nb) || (toSee[toCoord(x + 1, y)] == tmp_nb) || (toSee[toCoord(x - 1, y + 1)] == tmp_nb) || (toSee[toCoord(x, y + 1)] == tmp_nb)
-          || (toSee[toCoord(x + 1, y + 1)] == tmp_nb)){
-            do_tile (x*TILE_SIZE, y*TILE_SIZE, TILE_SIZE, TILE_SIZE, omp_get_thread_num());
-          }
-      }
-    }
-    #pragma omp parallel for schedule(dynamic,8)
-    for (int y = 1; y < NB_TILE-1; y += 1){
-        if((toSee[toCoord(0, y)] == tmp_nb) || (toSee[toCoord(0, y+1)] == tmp_nb) ||
-            (toSee[toCoord(0, y-1)] == tmp_nb) || (toSee[toCoord(1, y-1)] == tmp_nb) || (toSee[toCoord(1, y)] == tmp_nb)
-            || toSee[toCoord(1, y +1)]) do_tile (1, y*TILE_SIZE, TILE_SIZE-1, TILE_SIZE, omp_get_thread_num());
-        int x = NB_TILE-1;
-        if((toSee[toCoord(x-1, y -1)] == tmp_nb) || (toSee[toCoord(x-1, y)] == tmp_nb) ||
-            (toSee[toCoord(x, y -1)] == tmp_nb) || (toSee[toCoord(x, y)] == tmp_nb) || (toSee[toCoord(x-1, y +1)] == tmp_nb)
-            || (toSee[toCoord(x, y+1)] == tmp_nb)) do_tile (DIM-TILE_SIZE, y*TILE_SIZE, TILE_SIZE-1, TILE_SIZE, omp_get_thread_num());
-    }
-    #pragma omp parallel for schedule(dynamic,8)
-    for (int x = 1; x < NB_TILE-1; x += 1){
-        if((toSee[toCoord(x - 1, 0)] == tmp_nb) || (toSee[toCoord(x - 1, 1)] == tmp_nb) || (toSee[toCoord(x, 1)] == tmp_nb) || (toSee[toCoord(x + 1, 0)] == tmp_nb)
-           || (toSee[toCoord(x, 0)] == tmp_nb) || (toSee[toCoord(x + 1, 1)] == tmp_nb))
-          do_tile (x*TILE_SIZE, 1, TILE_SIZE, TILE_SIZE-1, omp_get_thread_num());
-        int y = NB_TILE-1;
-        if((toSee[toCoord(x - 1, y-1)] == tmp_nb) || (toSee[toCoord(x, y-1)] == tmp_nb) || (toSee[toCoord(x+1,y-1)] == tmp_nb)
-          || (toSee[toCoord(x - 1,y)] == tmp_nb) || (toSee[toCoord(x, y)] == tmp_nb) || (toSee[toCoord(x +1, y)] == tmp_nb))
-            do_tile (x*TILE_SIZE, DIM-TILE_SIZE, TILE_SIZE, TILE_SIZE-1, omp_get_thread_num());
-    }
-    if((toSee[toCoord(0, 0)] == tmp_nb) || (toSee[toCoord(1, 0)] == tmp_nb) || (toSee[toCoord(1, 1)] == tmp_nb)
-      || (toSee[toCoord(0,1)] == tmp_nb)) do_tile (1, 1, TILE_SIZE-1, TILE_SIZE-1,omp_get_thread_num());
-    int y = NB_TILE - 1;
-    if((toSee[toCoord(0,y-1)] == tmp_nb) || (toSee[toCoord(1,y)] == tmp_nb) || (toSee[toCoord(1,y-1)] == tmp_nb)
-      || (toSee[toCoord(0, y)] == tmp_nb)) do_tile (1, DIM-TILE_SIZE, TILE_SIZE-1, TILE_SIZE-1,omp_get_thread_num());
-    int x = NB_TILE-1;
-    if((toSee[toCoord(x - 1, 0)] == tmp_nb) || (toSee[toCoord(x, 1)] == tmp_nb) || (toSee[toCoord(x - 1, 1)] == tmp_nb)
-      || (toSee[toCoord(x, 0)] == tmp_nb)) do_tile (DIM-TILE_SIZE, 1, TILE_SIZE-1, TILE_SIZE-1,omp_get_thread_num());
-    indice = NB_TILE - 1;
-    if((toSee[toCoord(indice - 1, indice -1)] == tmp_nb) || (toSee[toCoord(indice - 1, indice)] == tmp_nb) || (toSee[toCoord(indice, indice)] == tmp_nb)
-      || (toSee[toCoord(indice, indice-1)] == tmp_nb)) do_tile (DIM-TILE_SIZE, DIM-TILE_SIZE, TILE_SIZE-1, TILE_SIZE-1,omp_get_thread_num());
-
-    int * tmp = toSee;
-    toSee = isUpdate;
-    isUpdate = tmp;
-
-    //printAled();
-    swap_tables ();
-    if (!changed) { // we stop when all cells are stable
-      res = it;
-      break;
-    }
-    changed = 0;
+  while (n->level < 3 || !hl_inner_half_only (n))
+    n = hl_expand (n);
+  n = hl_expand (n);
+
+  return hl_step (n, 0) == hl_center (n);
+}
+
+unsigned life_compute_hashlife (unsigned nb_iter)
+{
+  unsigned done = 0;
+
+  if (hl_root == NULL) {
+    unsigned level = 2;
+
+    while ((1U << level) < DIM)
+      level++;
+
+    hl_y0 = hl_x0 = 0;
+    hl_root       = hl_build (level, 0, 0);
+    bb_finalize ();
   }
 
-  return res;
+  monitoring_start_tile (0);
+
+  if (hl_is_still ()) {
+    monitoring_end_tile (0, 0, DIM, DIM, 0);
+    return 1;
+  }
+
+  // done is the largest number of generations <= nb_iter after which the
+  // universe is not still
+  for (int j = 8 * sizeof (unsigned) - 1; j >= 0; j--) {
+    if (nb_iter - done < (1U << j))
+      continue;
+
+    hl_node_t *root  = hl_root;
+    const int64_t y0 = hl_y0, x0 = hl_x0;
+
+    hl_push (root);
+    hl_advance (j);
+
+    if (hl_is_still ()) {
+      hl_root = root;
+      hl_y0   = y0;
+      hl_x0   = x0;
+    } else
+      done += 1U << j;
+    hl_stack_top--;
+  }
+
+  // Generation done + 1 is still, so generation done + 2 is the first one
+  // which does not change the universe
+  if (done < nb_iter)
+    hl_advance (0);
+
+  monitoring_end_tile (0, 0, DIM, DIM, 0);
+
+  return done + 1 < nb_iter ? done + 2 : 0;
 }
 
 ///////////////////////////// Initial configs
@@ -474,13 +4654,37 @@ void life_draw_meta3x3 (void);
 
 static inline void set_cell (int y, int x)
 {
-  cur_table (y, x) = 1;
-  if (opencl_used)
-    cur_img (y, x) = 1;
+  if (ut_buckets != NULL)
+    ut_set_cell (y, x);
+  else if (sp_cells != NULL)
+    sp_set_cell (y, x);
+  else if (_bb_table != NULL)
+    cur_bb (y, x / BB_BITS) |= (bb_word_t)1 << (x % BB_BITS);
+  else if (_blk_table != NULL)
+    cur_blk (y, x) = 1;
+  else {
+    cur_table (y, x) = 1;
+    live_box_valid   = 0;
+  }
 }
 
 static inline int get_cell (int y, int x)
 {
+  if (hl_root != NULL)
+    return hl_get_cell (y, x);
+
+  if (ut_buckets != NULL)
+    return ut_get_cell (y, x);
+
+  if (sp_cells != NULL)
+    return sp_get_cell (y, x);
+
+  if (_bb_table != NULL)
+    return (cur_bb (y, x / BB_BITS) >> (x % BB_BITS)) & 1;
+
+  if (_blk_table != NULL)
+    return cur_blk (y, x);
+
   return cur_table (y, x);
 }
 
@@ -488,6 +4692,14 @@ static void inline life_rle_parse (char *filename, int x, int y,
                                    int orientation)
 {
   rle_lexer_parse (filename, x, y, set_cell, orientation);
+
+  // The rule of the file applies, unless one was given on the command line
+  if (rle_lexer_rule () != NULL && rule_param == NULL) {
+    rule_init (rle_lexer_rule ());
+
+    if (!strncmp (variant_name, "lut", strlen ("lut")))
+      lut_init ();
+  }
 }
 
 static void inline life_rle_generate (char *filename, int x, int y, int width,
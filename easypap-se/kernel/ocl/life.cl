@@ -1,63 +1,52 @@
 #include "kernel/ocl/common.cl"
 #define NB_TILE (DIM/TILE_SIZE)
 
-#define table_cell(i, l, c) ((i) + (l) * DIM + (c))
+// Buffers have the layout of the host tables: a frame of one cell around the
+// board
+#define PAD_DIM (DIM + 2)
+#define table_cell(i, l, c) ((i) + ((l) + 1) * PAD_DIM + (c) + 1)
 #define cur_table(y, x) (*table_cell (in, (y), (x)))
 #define next_table(y, x) (*table_cell (out, (y), (x)))
-#define change(y, x) (*table_cell (c_in, (y), (x)))
-#define next_change(y, x) (*table_cell (c_out, (y), (x)))
 
-typedef unsigned cell_t;
+// Cells only hold 0 or 1, colours are computed by life_colour
+typedef uchar cell_t;
 
+// Torus mode: copies the opposite edges of the board into the frame, one
+// work item per row and column
+__kernel void life_frame (__global cell_t *in){
+    int i = get_global_id(0);
 
-__constant cell_t rules[2][9] = {
-    {0,0,0,0xFFFF00FF,0,0,0,0,0},
-    {0,0,0xFFFF00FF,0xFFFF00FF,0,0,0,0,0},
-};
+    cur_table(i, -1)  = cur_table(i, DIM - 1);
+    cur_table(i, DIM) = cur_table(i, 0);
+    cur_table(-1, i)  = cur_table(DIM - 1, i);
+    cur_table(DIM, i) = cur_table(0, i);
 
-__constant cell_t has_changed[2][9] = {
-    {0,0,0,1,0,0,0,0,0},
-    {1,1,0,0,1,1,1,1,1},
-};
+    if (i == 0) {
+        cur_table(-1, -1)  = cur_table(DIM - 1, DIM - 1);
+        cur_table(-1, DIM) = cur_table(DIM - 1, 0);
+        cur_table(DIM, -1) = cur_table(0, DIM - 1);
+        cur_table(DIM, DIM) = cur_table(0, 0);
+    }
+}
+
+// Bit n of born (resp. survive) is set if a dead (resp. living) cell with n
+// living neighbours is alive at the next generation. The frame is dead, or
+// refreshed by life_frame, so neighbours are read without any test.
+__kernel void life_ocl (__global cell_t *in, __global cell_t* out,
+                        unsigned born, unsigned survive){
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    unsigned n = cur_table(y - 1, x - 1) + cur_table(y - 1, x) + cur_table(y - 1, x + 1) +
+                 cur_table(y, x - 1) + cur_table(y, x + 1) +
+                 cur_table(y + 1, x - 1) + cur_table(y + 1, x) + cur_table(y + 1, x + 1);
 
+    next_table (y, x) = ((cur_table(y, x) ? survive : born) >> n) & 1;
+}
 
-__kernel void life_ocl (__global cell_t *in, __global cell_t* out){//,__global cell_t* c_in,__global cell_t* c_out) {
+// Living cells have the yellow color
+__kernel void life_colour (__global cell_t *in, __global unsigned *img){
     unsigned x = get_global_id(0);
     unsigned y = get_global_id(1);
-    unsigned tilex = get_local_id(0);
-    unsigned tiley = get_local_id(1);
-    barrier(CLK_LOCAL_MEM_FENCE);
-    unsigned n = 0;
-    //unsigned compute = change(tiley, tilex) | change(tiley, tilex+1) | change(tiley, tilex+2) | change(tiley+1, tilex) | change(tiley+1, tilex+1) | change(tiley+1, tilex+2) | change(tiley+2, tilex) | change(tiley+2, tilex+1)
-    //                | change(tiley+2, tilex+2);
-    //if(compute)
-    {
-        if(x>0 && y>0 && y<(DIM-1) && x<(DIM-1))
-        n = (cur_table(y-1, x-1)!=0) + (cur_table(y-1, x)!=0) + (cur_table(y-1, x+1)!=0) + (cur_table(y, x-1)!=0)  + (cur_table(y, x+1)!=0)  + (cur_table(y+1, x-1)!=0)
-            + (cur_table(y+1, x)!=0) + (cur_table(y+1, x+1)!=0) ;
-        else{
-            if(y == 0 &&  x>0 && x<(DIM-1))
-            n = (cur_table(y, x-1)!=0)  + (cur_table(y, x+1)!=0)  + (cur_table(y+1, x-1)!=0) + (cur_table(y+1, x)!=0) + (cur_table(y+1, x+1)!=0) ;
-            if(y == (DIM-1) &&  x>0 && x<(DIM-1))
-            n = (cur_table(y-1, x-1)!=0) + (cur_table(y-1, x)!=0) + (cur_table(y-1, x+1)!=0) + (cur_table(y, x-1)!=0)  + (cur_table(y, x+1)!=0) ;
-            else{
-                if(x == 0 &&  y>0 && y<(DIM-1))
-                n =  (cur_table(y-1, x)!=0) + (cur_table(y-1, x+1)!=0)  + (cur_table(y, x+1)!=0) + (cur_table(y+1, x)!=0) + (cur_table(y+1, x+1)!=0) ;
-                if(x == (DIM-1) &&  y>0 && y<(DIM-1))
-                n =  (cur_table(y-1, x)!=0) + (cur_table(y-1, x-1)!=0)  + (cur_table(y, x-1)!=0) + (cur_table(y+1, x)!=0) + (cur_table(y+1, x-1)!=0) ;
-                else{
-                    if(x == 0 &&  y==0)
-                    n = (cur_table(y, x+1)!=0) + (cur_table(y+1, x)!=0) + (cur_table(y+1, x+1)!=0) ;
-                    if(x == 0 &&  y==(DIM-1))
-                    n =  (cur_table(y-1, x)!=0) + (cur_table(y-1, x+1)!=0)  + (cur_table(y, x+1)!=0);
-                    if(x == (DIM-1) &&  y==0)
-                    n = (cur_table(y, x-1)!=0) + (cur_table(y+1, x)!=0) + (cur_table(y+1, x-1)!=0) ;
-                    if(x == (DIM-1) &&  y==(DIM-1))
-                    n =  (cur_table(y-1, x)!=0) + (cur_table(y-1, x-1)!=0)  + (cur_table(y, x-1)!=0);
-                }
-            }
-        }
-    }
-    next_table (y, x) = rules[cur_table(y, x)!=0][n];
-    //next_change (tilex+1,tiley+1) = has_changed[cur_table(y, x)!=0][n] | next_change (tilex+1,tiley+1);
+
+    img[y * DIM + x] = cur_table(y, x) ? 0xFFFF00FF : 0;
 }
@@ -45,7 +45,7 @@ def shuffle(u, v, sepa=" "):
 
 def creationLegende(datasForGrapheNames, df):
 
-    attr = complementaryCols(['time', 'ref'] + datasForGrapheNames +
+    attr = complementaryCols(['time', 'period', 'ref'] + datasForGrapheNames +
                              [i for i in list(df.columns) if df[i].nunique() == 1], df)
 
     if attr == []:
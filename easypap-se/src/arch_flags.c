@@ -7,6 +7,9 @@ void arch_flags_print (void)
 
 #if AVX2 == 1
   PRINT_DEBUG ('c', "AVX2 Vectorization enabled (VEC_SIZE: %d)\n", VEC_SIZE);
+#if AVX512 == 1
+  PRINT_DEBUG ('c', "AVX-512 instructions available\n");
+#endif
 #elif SSE == 1
   PRINT_DEBUG ('c', "SSE Vectorization enabled (VEC_SIZE: %d)\n", VEC_SIZE);
 #endif
@@ -21,6 +21,7 @@ draw_func_t the_draw        = NULL;
 void_func_t the_finalize    = NULL;
 int_func_t the_compute      = NULL;
 void_func_t the_refresh_img = NULL;
+period_func_t the_period    = NULL;
 
 void *hooks_find_symbol (char *symbol)
 {
@@ -69,6 +70,7 @@ void hooks_establish_bindings (void)
   the_draw        = bind_it (kernel_name, "draw", variant_name, 0);
   the_finalize    = bind_it (kernel_name, "finalize", variant_name, 0);
   the_refresh_img = bind_it (kernel_name, "refresh_img", variant_name, 0);
+  the_period      = bind_it (kernel_name, "period", variant_name, 0);
 
   if (!opencl_used) {
     the_first_touch = bind_it (kernel_name, "ft", variant_name, do_first_touch);
@@ -1,25 +1,27 @@
 #include <stdlib.h>
 #include <string.h>
-#include <sys/mman.h>
 
 #include "debug.h"
 #include "error.h"
 #include "global.h"
 #include "img_data.h"
+#include "vec_aligned_alloc.h"
 
 uint32_t *restrict image = NULL, *restrict alt_image = NULL;
 
 unsigned DIM   = 0, GRAIN = 0, TILE_SIZE = 0;
 
+unsigned img_data_lazy = 0;
+
 void img_data_alloc (void)
 {
-  image = mmap (NULL, DIM * DIM * sizeof (uint32_t), PROT_READ | PROT_WRITE,
-                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  const size_t size = (size_t)DIM * DIM * sizeof (uint32_t);
+
+  image = img_data_lazy ? huge_alloc_lazy (size) : huge_alloc (size);
   if (image == NULL)
     exit_with_error ("Cannot allocate main image: mmap failed");
 
-  alt_image = mmap (NULL, DIM * DIM * sizeof (uint32_t), PROT_READ | PROT_WRITE,
-                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  alt_image = img_data_lazy ? huge_alloc_lazy (size) : huge_alloc (size);
   if (alt_image == NULL)
     exit_with_error ("Cannot allocate alternate image: mmap failed");
 
@@ -29,17 +31,17 @@ void img_data_alloc (void)
 void img_data_free (void)
 {
   if (image != NULL) {
-    munmap (image, DIM * DIM * sizeof (uint32_t));
+    huge_free (image, (size_t)DIM * DIM * sizeof (uint32_t));
     image = NULL;
   }
 
   if (alt_image != NULL) {
-    munmap (alt_image, DIM * DIM * sizeof (uint32_t));
+    huge_free (alt_image, (size_t)DIM * DIM * sizeof (uint32_t));
     alt_image = NULL;
   }
 }
 
 void img_data_replicate (void)
 {
-  memcpy (alt_image, image, DIM * DIM * sizeof (uint32_t));
+  memcpy (alt_image, image, (size_t)DIM * DIM * sizeof (uint32_t));
 }
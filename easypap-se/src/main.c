@@ -32,6 +32,8 @@ static char *progname    = NULL;
 char *variant_name       = NULL;
 char *kernel_name        = NULL;
 char *draw_param         = NULL;
+char *rule_param         = NULL;
+char *boundary_param     = NULL;
 char *easypap_image_file = NULL;
 
 static char *output_file = "./plots/data/perf_data.csv";
@@ -46,6 +48,7 @@ static unsigned do_pause                                   = 0;
 static unsigned quit_when_done                             = 0;
 static unsigned nb_cores                                   = 1;
 unsigned do_first_touch                                    = 0;
+static unsigned cycle_period                               = 0;
 static unsigned do_dump __attribute__ ((unused))           = 0;
 static unsigned do_thumbs __attribute__ ((unused))         = 0;
 static unsigned show_ocl_config                            = 0;
@@ -116,29 +119,56 @@ static void update_refresh_rate (int p)
   printf ("< Refresh rate set to: %d >\n", refresh_rate);
 }
 
+// Returns 1 if the header of the existing output file has the period column,
+// which files created before it was added lack
+static int output_has_period (void)
+{
+  FILE *f = fopen (output_file, "r");
+  char header[1024];
+  int res = 0;
+
+  if (f == NULL)
+    return 0;
+
+  if (fgets (header, sizeof (header), f) != NULL)
+    res = strstr (header, ";period") != NULL;
+
+  fclose (f);
+
+  return res;
+}
+
 static void output_perf_numbers (long time_in_us, unsigned nb_iter)
 {
   FILE *f = fopen (output_file, "a");
   struct utsname s;
+  int period;
 
   if (f == NULL)
     exit_with_error ("Cannot open \"%s\" file (%s)", output_file,
                      strerror (errno));
 
   if (ftell (f) == 0) {
-    fprintf (f, "%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s\n", "machine", "dim", "grain",
-             "threads", "kernel", "variant", "iterations", "schedule", "label",
-             "arg", "time");
-  }
+    fprintf (f, "%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s\n", "machine", "dim",
+             "grain", "threads", "kernel", "variant", "iterations", "schedule",
+             "label", "arg", "time", "period");
+    period = 1;
+  } else
+    period = output_has_period ();
 
   if (uname (&s) < 0)
     exit_with_error ("uname failed (%s)", strerror (errno));
 
-  fprintf (f, "%s;%u;%u;%u;%s;%s;%u;%s;%s;%s;%ld\n", s.nodename, DIM, GRAIN,
+  fprintf (f, "%s;%u;%u;%u;%s;%s;%u;%s;%s;%s;%ld", s.nodename, DIM, GRAIN,
            easypap_requested_number_of_threads (), kernel_name, variant_name,
            nb_iter, easypap_omp_schedule (), (label ?: "unlabelled"),
            (draw_param ?: "none"), time_in_us);
 
+  // Rows appended to an older file keep its columns
+  if (period)
+    fprintf (f, ";%u", cycle_period);
+  fprintf (f, "\n");
+
   fclose (f);
 }
 
@@ -419,6 +449,8 @@ int main (int argc, char **argv)
             if (n > 0) {
               iterations += n;
               stable = 1;
+              if (the_period != NULL)
+                cycle_period = the_period ();
               PRINT_MASTER ("Computation completed after %d itérations\n",
                             iterations);
             } else
@@ -495,6 +527,8 @@ int main (int argc, char **argv)
         if (n > 0) {
           iterations += n;
           stable = 1;
+          if (the_period != NULL)
+            cycle_period = the_period ();
         } else
           iterations += refresh_rate;
       }
@@ -506,6 +540,9 @@ int main (int argc, char **argv)
     gettimeofday (&t2, NULL);
 
     PRINT_MASTER ("Computation completed after %d iterations\n", iterations);
+    if (cycle_period > 1)
+      PRINT_MASTER ("Board entered a cycle of period %u at iteration %d\n",
+                    cycle_period, iterations - cycle_period);
 
     temps = TIME_DIFF (t1, t2);
 
@@ -564,6 +601,8 @@ static void usage (int val)
   fprintf (
       stderr,
       "\t-a\t| --arg <string>\t: pass argument <string> to draw function\n");
+  fprintf (stderr, "\t-bo\t| --boundary <mode>\t: use dead (default) or torus "
+                   "boundaries\n");
   fprintf (
       stderr,
       "\t-d\t| --debug-flags <flags>\t: enable debug messages (see debug.h)\n");
@@ -593,6 +632,8 @@ static void usage (int val)
   fprintf (stderr, "\t-q\t| --quit\t\t: exit once iterations are done\n");
   fprintf (stderr,
            "\t-r\t| --refresh-rate <N>\t: display only 1/Nth of images\n");
+  fprintf (stderr, "\t-ru\t| --rule <B/S>\t\t: use Life-like rule <B/S> "
+                   "(e.g. B36/S23)\n");
   fprintf (stderr, "\t-s\t| --size <DIM>\t\t: use image of size DIM x DIM\n");
   fprintf (stderr,
            "\t-sr\t| --soft-rendering\t: disable hardware acceleration\n");
@@ -671,6 +712,22 @@ static void filter_args (int *argc, char *argv[])
       (*argc)--;
       argv++;
       draw_param = *argv;
+    } else if (!strcmp (*argv, "--rule") || !strcmp (*argv, "-ru")) {
+      if (*argc == 1) {
+        fprintf (stderr, "Error: rule is missing\n");
+        usage (1);
+      }
+      (*argc)--;
+      argv++;
+      rule_param = *argv;
+    } else if (!strcmp (*argv, "--boundary") || !strcmp (*argv, "-bo")) {
+      if (*argc == 1) {
+        fprintf (stderr, "Error: boundary mode is missing\n");
+        usage (1);
+      }
+      (*argc)--;
+      argv++;
+      boundary_param = *argv;
     } else if (!strcmp (*argv, "--label") || !strcmp (*argv, "-lb")) {
       if (*argc == 1) {
         fprintf (stderr, "Error: parameter string is missing\n");
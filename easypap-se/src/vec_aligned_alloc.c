@@ -1,7 +1,9 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <sys/mman.h>
 
+#include "debug.h"
 #include "vec_aligned_alloc.h"
 
 // VEC_ALIGNMENT (in bytes) must be a power of two
@@ -45,3 +47,98 @@ void vec_aligned_free (void *p)
     free (real);
   }
 }
+
+#define HUGE_2M ((size_t)1 << 21)
+#define HUGE_1G ((size_t)1 << 30)
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#define HUGE_FLAG(size) (__builtin_ctzl (size) << MAP_HUGE_SHIFT)
+
+// Buffers of at least 2 MiB are rounded up to a whole number of 2 MiB pages
+static size_t huge_length (size_t size)
+{
+  return size < HUGE_2M ? size : (size + HUGE_2M - 1) & ~(HUGE_2M - 1);
+}
+
+static void *huge_try (size_t len, size_t page)
+{
+#ifdef MAP_HUGETLB
+  void *p = mmap (NULL, len, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | HUGE_FLAG (page),
+                  -1, 0);
+
+  return p == MAP_FAILED ? NULL : p;
+#else
+  return NULL;
+#endif
+}
+
+// Zero-filled buffer backed by huge pages when possible: explicit 1 GiB or
+// 2 MiB pages (MAP_HUGETLB) if some are reserved and explicit is set,
+// otherwise transparent huge pages on a 2 MiB aligned mapping. Returns NULL on
+// failure.
+static void *huge_map (size_t size, int explicit)
+{
+  const size_t len = huge_length (size);
+  void *p;
+
+  if (size < HUGE_2M) {
+    p = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+  }
+
+  // Explicit huge pages are taken from the pool as soon as they are mapped
+  if (explicit) {
+    if (len % HUGE_1G == 0 && (p = huge_try (len, HUGE_1G)) != NULL) {
+      PRINT_DEBUG ('i', "%zu bytes allocated on 1 GiB pages\n", len);
+      return p;
+    }
+
+    if ((p = huge_try (len, HUGE_2M)) != NULL) {
+      PRINT_DEBUG ('i', "%zu bytes allocated on 2 MiB pages\n", len);
+      return p;
+    }
+  }
+
+  // Extra 2 MiB so that the mapping can be trimmed to a 2 MiB boundary
+  char *raw = mmap (NULL, len + HUGE_2M, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED)
+    return NULL;
+
+  char *start = (char *)(((uintptr_t)raw + HUGE_2M - 1) & ~(HUGE_2M - 1));
+
+  if (start > raw)
+    munmap (raw, start - raw);
+  munmap (start + len, raw + HUGE_2M - start);
+
+#ifdef MADV_HUGEPAGE
+  if (!madvise (start, len, MADV_HUGEPAGE)) {
+    PRINT_DEBUG ('i', "%zu bytes allocated on transparent huge pages\n", len);
+    return start;
+  }
+#endif
+
+  PRINT_DEBUG ('i', "%zu bytes allocated on regular pages\n", len);
+  return start;
+}
+
+void *huge_alloc (size_t size)
+{
+  return huge_map (size, 1);
+}
+
+void *huge_alloc_lazy (size_t size)
+{
+  return huge_map (size, 0);
+}
+
+void huge_free (void *p, size_t size)
+{
+  if (p != NULL)
+    munmap (p, huge_length (size));
+}